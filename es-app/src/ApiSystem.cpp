@@ -12,6 +12,7 @@
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "utils/ThreadPool.h"
+#include "utils/TaskScheduler.h"
 #include "RetroAchievements.h"
 #include "utils/ZipFile.h"
 #include "Paths.h"
@@ -24,6 +25,9 @@
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <list>
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
@@ -80,6 +84,154 @@ ApiSystem::ApiSystem() { }
 
 ApiSystem* ApiSystem::instance = nullptr;
 
+// Asynchronous queries
+#define QUERY_WORKERS 2
+
+struct AsyncQuery
+{
+	std::shared_ptr<void> result;
+	int time;
+	int ttl;
+};
+
+static std::map<std::string, AsyncQuery>       mQueries;
+static std::mutex                              mQueriesLock;
+
+static Utils::TaskGroup*                        mQueryGroup = nullptr;
+static std::mutex                              mQueryGroupLock;
+static bool                                    mQueryExit = false;
+
+static std::vector<std::function<bool()>>      mQueryContinuations;
+static std::mutex                              mQueryContinuationsLock;
+
+std::shared_ptr<void> ApiSystem::getQuery(const std::string& key, int ttl, const std::function<std::shared_ptr<void>()>& create)
+{
+	std::unique_lock<std::mutex> lock(mQueriesLock);
+
+	int now = (int)SDL_GetTicks();
+
+	auto it = mQueries.find(key);
+	if (it != mQueries.cend() && (it->second.ttl <= 0 || now - it->second.time < it->second.ttl))
+		return it->second.result;
+
+	AsyncQuery query;
+	query.result = create();
+	query.time = now;
+	query.ttl = ttl;
+	mQueries[key] = query;
+
+	return query.result;
+}
+
+void ApiSystem::invalidateQuery(const std::string& key)
+{
+	std::unique_lock<std::mutex> lock(mQueriesLock);
+
+	if (key.empty())
+		mQueries.clear();
+	else
+		mQueries.erase(key);
+}
+
+void ApiSystem::enqueueQuery(const std::function<void()>& func)
+{
+	std::unique_lock<std::mutex> lock(mQueryGroupLock);
+
+	if (mQueryExit)
+		return;
+
+	// Queries run in order, QUERY_WORKERS at once
+	if (mQueryGroup == nullptr)
+		mQueryGroup = new Utils::TaskGroup(QUERY_WORKERS, Utils::TaskScheduler::INTERACTIVE);
+
+	mQueryGroup->run(func);
+}
+
+void ApiSystem::addQueryContinuation(const std::function<bool()>& continuation)
+{
+	// Under the lock : the query is either ready now, or its task has not swept the continuations yet
+	std::unique_lock<std::mutex> lock(mQueryContinuationsLock);
+
+	if (!continuation())
+		mQueryContinuations.push_back(continuation);
+}
+
+void ApiSystem::runQueryContinuations()
+{
+	std::unique_lock<std::mutex> lock(mQueryContinuationsLock);
+
+	auto it = mQueryContinuations.begin();
+	while (it != mQueryContinuations.end())
+	{
+		if ((*it)())
+			it = mQueryContinuations.erase(it);
+		else
+			it++;
+	}
+}
+
+void ApiSystem::stopQueries()
+{
+	Utils::TaskGroup* group;
+
+	{
+		std::unique_lock<std::mutex> lock(mQueryGroupLock);
+		mQueryExit = true;
+
+		group = mQueryGroup;
+		mQueryGroup = nullptr;
+	}
+
+	if (group != nullptr)
+	{
+		group->cancel();
+		delete group;
+	}
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::getAvailableVideoOutputDevicesAsync()
+{
+	return queryAsync<std::vector<std::string>>("videooutputs", [this]() { return getAvailableVideoOutputDevices(); });
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::getAvailableAudioOutputDevicesAsync()
+{
+	return queryAsync<std::vector<std::string>>("audiooutputs", [this]() { return getAvailableAudioOutputDevices(); });
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::getAvailableStorageDevicesAsync()
+{
+	return queryAsync<std::vector<std::string>>("storage", [this]() { return getAvailableStorageDevices(); });
+}
+
+std::shared_future<std::vector<std::string>> ApiSystem::getTimezonesAsync()
+{
+	return queryAsync<std::vector<std::string>>("timezones", [this]() { return getTimezones(); }, 0);
+}
+
+std::shared_future<std::vector<Service>> ApiSystem::getServicesAsync()
+{
+	return queryAsync<std::vector<Service>>("services", [this]() { return getServices(); });
+}
+
+void ApiSystem::prefetchMenuQueries()
+{
+	// Enumerations the system settings are most likely to need
+#ifdef BATOCERA
+	getAvailableVideoOutputDevicesAsync();
+	getAvailableStorageDevicesAsync();
+#endif
+
+	if (isScriptingSupported(ApiSystem::AUDIODEVICE))
+		getAvailableAudioOutputDevicesAsync();
+
+	if (isScriptingSupported(ApiSystem::TIMEZONES))
+		getTimezonesAsync();
+
+	if (isScriptingSupported(ApiSystem::SERVICES))
+		getServicesAsync();
+}
+
 ApiSystem *ApiSystem::getInstance() 
 {
 	if (ApiSystem::instance == nullptr)
@@ -666,6 +818,7 @@ std::string ApiSystem::getCurrentStorage()
 
 bool ApiSystem::setStorage(std::string selected) 
 {
+	invalidateQuery("storage");
 	return executeScript("batocera-config storage " + selected);
 }
 
@@ -2301,6 +2454,8 @@ bool ApiSystem::enableService(std::string name, bool enable)
 
 	LOG(LogDebug) << "ApiSystem::enableService " << serviceName;
 
+	invalidateQuery("services");
+
 	bool res = executeScript("batocera-services " + std::string(enable ? "enable" : "disable") + " " + serviceName);
 	if (res)
 		res = executeScript("batocera-services " + std::string(enable ? "start" : "stop") + " " + serviceName);
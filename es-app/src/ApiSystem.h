@@ -3,6 +3,8 @@
 
 #include <string>
 #include <map>
+#include <future>
+#include <functional>
 #include "Window.h"
 #include "components/BusyComponent.h"
 #include "resources/TextureData.h"
@@ -295,6 +297,57 @@ public:
 	virtual std::vector<std::string> backglassThemes();
 	virtual void restartBackglass();
 
+	// Asynchronous queries : the query runs on the TaskScheduler, and its result is shared by all callers for 'ttl' milliseconds.
+	// A key must always be used with the same result type.
+	template<typename T>
+	std::shared_future<T> queryAsync(const std::string& key, const std::function<T()>& query, int ttl = 30000)
+	{
+		std::shared_ptr<std::packaged_task<T()>> task;
+
+		auto result = std::static_pointer_cast<std::shared_future<T>>(getQuery(key, ttl, [&task, &query]()
+		{
+			task = std::make_shared<std::packaged_task<T()>>(query);
+			return std::static_pointer_cast<void>(std::make_shared<std::shared_future<T>>(task->get_future().share()));
+		}));
+
+		if (task != nullptr)
+			enqueueQuery([this, task]()
+			{
+				(*task)();
+				runQueryContinuations();
+			});
+
+		return *result;
+	}
+
+	// Calls 'func' on the UI thread once the result is available. Nothing waits for it : the query task posts the call when it completes
+	template<typename T>
+	void onQueryReady(Window* window, const std::shared_future<T>& result, const std::function<void(const T&)>& func)
+	{
+		addQueryContinuation([window, result, func]()
+		{
+			if (!isQueryReady(result))
+				return false;
+
+			T value = result.get();
+			window->postToUiThread([value, func]() { func(value); });
+			return true;
+		});
+	}
+
+	template<typename T>
+	static bool isQueryReady(const std::shared_future<T>& result) { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+	void invalidateQuery(const std::string& key = "");
+	void prefetchMenuQueries();
+	void stopQueries();
+
+	std::shared_future<std::vector<std::string>> getAvailableVideoOutputDevicesAsync();
+	std::shared_future<std::vector<std::string>> getAvailableAudioOutputDevicesAsync();
+	std::shared_future<std::vector<std::string>> getAvailableStorageDevicesAsync();
+	std::shared_future<std::vector<std::string>> getTimezonesAsync();
+	std::shared_future<std::vector<Service>> getServicesAsync();
+
 protected:
 	ApiSystem();
 
@@ -311,6 +364,14 @@ protected:
 
     void launchExternalWindow_before(Window *window);
     void launchExternalWindow_after(Window *window);
+
+private:
+	std::shared_ptr<void> getQuery(const std::string& key, int ttl, const std::function<std::shared_ptr<void>()>& create);
+	void enqueueQuery(const std::function<void()>& func);
+
+	// A continuation returns true once its query is ready and it has run
+	void addQueryContinuation(const std::function<bool()>& continuation);
+	void runQueryContinuations();
 };
 
 #endif
@@ -20,8 +20,10 @@
 #include "views/gamelist/ISimpleGameListView.h"
 #include "PlatformId.h"
 #include "utils/ThreadPool.h"
+#include "utils/TaskScheduler.h"
 #include "Genres.h"
 #include "Paths.h"
+#include <mutex>
 
 std::string myCollectionsName = "collections";
 
@@ -391,7 +393,7 @@ void CollectionSystemManager::updateSystemsList()
 	removeCollectionsFromDisplayedSystems();
 
 	std::unordered_map<std::string, FileData*> map;
-	getAllGamesCollection()->getRootFolder()->createChildrenByFilenameMap(map);
+	createAllGamesMap(map);
 
 	// add custom enabled ones
 	addEnabledCollectionsToDisplayedSystems(&mCustomCollectionSystemsData, &map);
@@ -437,7 +439,18 @@ void CollectionSystemManager::updateSystemsList()
 // updates all collection files related to the source file
 void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 {
-	if (!file->getSystem()->isGameSystem() || file->getType() != GAME)
+	refreshCollectionSystems(std::vector<FileData*> { file });
+}
+
+// updates all collection files related to a batch of source files, each collection view is refreshed once
+void CollectionSystemManager::refreshCollectionSystems(const std::vector<FileData*>& files)
+{
+	std::vector<FileData*> games;
+	for (auto file : files)
+		if (file->getType() == GAME && file->getSystem()->isGameSystem())
+			games.push_back(file);
+
+	if (games.size() == 0)
 		return;
 
 	std::map<std::string, CollectionSystemData> allCollections;
@@ -445,54 +458,87 @@ void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
 
 	for (auto sys : allCollections)
-		updateCollectionSystem(file, sys.second);
+		updateCollectionSystem(games, sys.second);
 }
 
 void CollectionSystemManager::updateCollectionSystem(FileData* file, const CollectionSystemData& sysData)
 {
-	if (!sysData.isPopulated)
-		return;
+	updateCollectionSystem(std::vector<FileData*> { file }, sysData);
+}
 
-	// collection files use the full path as key, to avoid clashes
-	std::string key = file->getFullPath();
+void CollectionSystemManager::updateCollectionSystem(const std::vector<FileData*>& files, const CollectionSystemData& sysData)
+{
+	if (!sysData.isPopulated || files.size() == 0)
+		return;
 
 	SystemData* curSys = sysData.system;
-	FileData*   collectionEntry = curSys->getRootFolder()->FindByPath(key);
 	FolderData* rootFolder = curSys->getRootFolder();
 	std::string name = curSys->getName();
 
 	auto view = ViewController::get()->getGameListView(curSys, false);
 
-	if (collectionEntry != nullptr)
+	// collection files use the full path as key, to avoid clashes
+	// A batch looks them up in a map built once, instead of walking the collection for each file
+	bool useMap = files.size() > 1;
+
+	std::unordered_map<std::string, FileData*> entries;
+	if (useMap)
+		for (auto entry : rootFolder->getFilesRecursive(GAME))
+			entries[entry->getPath()] = entry;
+
+	bool contentChanged = false;
+
+	for (auto file : files)
 	{
-		// remove from index, so we can re-index metadata after refreshing
-		curSys->removeFromIndex(collectionEntry);
+		std::string key = file->getFullPath();
 
-		// found and we are removing
-		if (name == "favorites" && !file->getFavorite())
+		FileData* collectionEntry = nullptr;
+		if (useMap)
 		{
-			if (view != nullptr)
-				view.get()->remove(collectionEntry);
-			else
-				delete collectionEntry;
-
-			collectionEntry = nullptr;
+			auto it = entries.find(key);
+			if (it != entries.cend())
+				collectionEntry = it->second;
 		}
 		else
+			collectionEntry = rootFolder->FindByPath(key);
+
+		if (collectionEntry != nullptr)
 		{
-			// re-index with new metadata
-			curSys->addToIndex(collectionEntry);
+			// remove from index, so we can re-index metadata after refreshing
+			curSys->removeFromIndex(collectionEntry);
+
+			// found and we are removing
+			if (name == "favorites" && !file->getFavorite())
+			{
+				if (view != nullptr)
+					view.get()->remove(collectionEntry);
+				else
+					delete collectionEntry;
+
+				entries.erase(key);
+				contentChanged = true;
+			}
+			else
+			{
+				// re-index with new metadata
+				curSys->addToIndex(collectionEntry);
+			}
 		}
-	}
-	else
-	{
-		// we didn't find it here - we need to check if we should add it
-		if (name == "recent" && file->getMetadata(MetaDataId::PlayCount) > "0" && includeFileInAutoCollections(file) ||
-			name == "favorites" && file->getFavorite())
+		else
 		{
-			auto newGame = new CollectionFileData(file, curSys);
-			rootFolder->addChild(newGame);
-			curSys->addToIndex(newGame);
+			// we didn't find it here - we need to check if we should add it
+			if (name == "recent" && file->getMetadata(MetaDataId::PlayCount) > "0" && includeFileInAutoCollections(file) ||
+				name == "favorites" && file->getFavorite())
+			{
+				auto newGame = new CollectionFileData(file, curSys);
+				rootFolder->addChild(newGame);
+				curSys->addToIndex(newGame);
+
+				if (useMap)
+					entries[key] = newGame;
+			}
+
+			contentChanged = true;
 		}
 	}
 
@@ -505,7 +551,7 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, const Colle
 	}
 	
 	if (view != nullptr)
-		view->onFileChanged(rootFolder, name == "recent" || collectionEntry == nullptr ? FILE_METADATA_CHANGED : FILE_SORTED);
+		view->onFileChanged(rootFolder, name == "recent" || contentChanged ? FILE_METADATA_CHANGED : FILE_SORTED);
 }
 
 void CollectionSystemManager::sortLastPlayed(SystemData* system)
@@ -516,12 +562,8 @@ void CollectionSystemManager::sortLastPlayed(SystemData* system)
 	FolderData* rootFolder = system->getRootFolder();
 	system->setSortId(FileSorts::LASTPLAYED_DESCENDING);
 
-	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(system->getSortId());
-
 	std::vector<FileData*>& childs = (std::vector<FileData*>&) rootFolder->getChildren();
-	std::sort(childs.begin(), childs.end(), sort.comparisonFunction);
-	if (!sort.ascending)
-		std::reverse(childs.begin(), childs.end());
+	FileSorts::sortFiles(childs, FileSorts::LASTPLAYED_DESCENDING);
 }
 
 void CollectionSystemManager::trimCollectionCount(FolderData* rootFolder, int limit)
@@ -551,6 +593,18 @@ void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
 	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
 
+	FileData* sourceFile = file->getSourceFileData();
+
+	{
+		std::unique_lock<std::mutex> lock(mAutoCollectionGamesLock);
+
+		for (auto& autoCollection : mAutoCollectionSystemsData)
+		{
+			auto& games = autoCollection.second.games;
+			games.erase(std::remove(games.begin(), games.end(), sourceFile), games.end());
+		}
+	}
+
 	for (auto sysDataIt = allCollections.begin(); sysDataIt != allCollections.end(); sysDataIt++)
 	{
 		if (!sysDataIt->second.isPopulated)
@@ -878,22 +932,42 @@ void CollectionSystemManager::initCustomCollectionSystems()
 		addNewCustomCollection(name, false);
 }
 
-SystemData* CollectionSystemManager::getArcadeCollection()
+void CollectionSystemManager::createAllGamesMap(std::unordered_map<std::string, FileData*>& map)
 {
-	CollectionSystemData* allSysData = &mAutoCollectionSystemsData["arcade"];
-	if (!allSysData->isPopulated)
-		populateAutoCollection(allSysData);
-
-	return allSysData->system;
+	// collection files use the full path as key
+	for (auto game : getAutoCollectionGames("all"))
+		map[game->getFullPath()] = game;
 }
 
-SystemData* CollectionSystemManager::getAllGamesCollection()
+std::vector<FileData*> CollectionSystemManager::getAutoCollectionGames(const std::string& name)
 {
-	CollectionSystemData* allSysData = &mAutoCollectionSystemsData["all"];
-	if (!allSysData->isPopulated)
-		populateAutoCollection(allSysData);
+	std::vector<FileData*> ret;
+
+	auto it = mAutoCollectionSystemsData.find(name);
+	if (it == mAutoCollectionSystemsData.cend())
+		return ret;
 
-	return allSysData->system;
+	CollectionSystemData* sysData = &it->second;
+	if (sysData->isPopulated)
+	{
+		for (auto file : sysData->system->getRootFolder()->getChildren())
+			ret.push_back(file->getSourceFileData());
+
+		return ret;
+	}
+
+	// Callers may run in parallel (custom collections) : the list is rebuilt and copied under the lock
+	std::unique_lock<std::mutex> lock(mAutoCollectionGamesLock);
+
+	// Games were added to the tree since the list was built
+	if (!sysData->isIndexed || sysData->indexGeneration != FolderData::getTreeGeneration())
+	{
+		std::vector<CollectionSystemData*> collections;
+		collections.push_back(sysData);
+		populateAutoCollections(collections, false);
+	}
+
+	return sysData->games;
 }
 
 SystemData* CollectionSystemManager::addNewCustomCollection(std::string name, bool needSave)
@@ -928,6 +1002,8 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 	newCollectionData.isEnabled = false;
 	newCollectionData.isPopulated = false;
 	newCollectionData.needsSave = false;
+	newCollectionData.isIndexed = false;
+	newCollectionData.indexGeneration = 0;
 	newCollectionData.filteredIndex = nullptr;
 
 	if (index)
@@ -951,17 +1027,109 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 	return newSys;
 }
 
+// The test deciding if a game belongs to an auto collection, with everything that doesn't depend on the game resolved once
+struct AutoCollectionPredicate
+{
+	AutoCollectionPredicate(CollectionSystemDecl& decl) : type(decl.type), genre(-1), arcadeSubSystem(false)
+	{
+		if (!decl.isCustom && !decl.displayIfEmpty)
+		{
+			if (decl.isGenreCollection())
+				genre = ((int)decl.type) - 10000;
+			else if (decl.isArcadeSubSystem())
+			{
+				arcadeSubSystem = true;
+				arcadeSystemName = decl.themeFolder;
+			}
+		}
+	}
+
+	bool matches(FileData* game, bool isArcade) const
+	{
+		switch (type)
+		{
+		case AUTO_ALL_GAMES:
+			return true;
+		case AUTO_VERTICALARCADE:
+			return game->isVerticalArcadeGame();
+		case AUTO_LIGHTGUN:
+			return game->isLightGunGame();
+		case AUTO_WHEEL:
+			return game->isWheelGame();
+		case AUTO_TRACKBALL:
+			return game->isTrackballGame();
+		case AUTO_SPINNER:
+			return game->isSpinnerGame();
+		case AUTO_RETROACHIEVEMENTS:
+			return game->hasCheevos();
+		case AUTO_LAST_PLAYED:
+			return game->getMetadata(MetaDataId::PlayCount) > "0";
+		case AUTO_NEVER_PLAYED:
+			return !(game->getMetadata(MetaDataId::PlayCount) > "0");
+		case AUTO_FAVORITES:
+			// we may still want to add files we don't want in auto collections in "favorites"
+			return game->getFavorite();
+		case AUTO_ARCADE:
+			return isArcade;
+		case AUTO_AT2PLAYERS:
+		case AUTO_AT4PLAYERS:
+			{
+				if (game->getMetadata(MetaDataId::Players).empty())
+					return false;
+
+				auto range = game->parsePlayersRange();
+
+				int val = (type == AUTO_AT2PLAYERS ? 2 : 4);
+				return range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
+			}
+		default:
+			break;
+		}
+
+		if (genre >= 0)
+			return Genres::genreExists(&game->getMetadata(), genre);
+
+		if (arcadeSubSystem)
+			return isArcade && game->getMetadata(MetaDataId::ArcadeSystemName) == arcadeSystemName;
+
+		return true;
+	}
+
+	CollectionSystemType type;
+	int  genre;
+	bool arcadeSubSystem;
+	std::string arcadeSystemName;
+};
+
 // populates an Automatic Collection System
 void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData)
 {
-	SystemData* newSys = sysData->system;
-	CollectionSystemDecl sysDecl = sysData->decl;
-	FolderData* rootFolder = newSys->getRootFolder();
+	std::vector<CollectionSystemData*> collections;
+	collections.push_back(sysData);
+	populateAutoCollections(collections);
+}
+
+// populates several Automatic Collection Systems with a single pass over the games, in parallel per source system.
+// Without createEntries, only the source games are kept in CollectionSystemData::games, mAutoCollectionGamesLock must be held
+void CollectionSystemManager::populateAutoCollections(const std::vector<CollectionSystemData*>& collections, bool createEntries)
+{
+	if (collections.size() == 0)
+		return;
+
+	StopWatch stopWatch("populateAutoCollections (" + std::to_string(collections.size()) + ") :", LogDebug);
+
+	// Taken before the pass : games added meanwhile invalidate the lists built now
+	unsigned int generation = FolderData::getTreeGeneration();
+
+	std::vector<AutoCollectionPredicate> predicates;
+	for (auto collection : collections)
+		predicates.push_back(AutoCollectionPredicate(collection->decl));
 
 	bool hiddenSystemsShowGames = Settings::HiddenSystemsShowGames();
 	auto hiddenSystems = Utils::String::split(Settings::getInstance()->getString("HiddenSystems"), ';');
 
-	for (auto& system : SystemData::sSystemVector)
+	std::vector<SystemData*> systems;
+	for (auto system : SystemData::sSystemVector)
 	{
 		// we won't iterate all collections
 		if (!system->isGameSystem() || system->isCollection())
@@ -973,20 +1141,29 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		if (system->hasPlatformId(PlatformIds::PLATFORM_IGNORE) || system->hasPlatformId(PlatformIds::IMAGEVIEWER))
 			continue;
 
+		systems.push_back(system);
+	}
+
+	// matches[system][collection] : the games of this system to add to this collection, in the system order
+	std::vector<std::vector<std::vector<FileData*>>> matches(systems.size(), std::vector<std::vector<FileData*>>(collections.size()));
+
+	auto classifySystem = [this, &systems, &predicates, &matches](size_t index)
+	{
+		SystemData* system = systems[index];
+		auto& systemMatches = matches[index];
+
 		bool isArcade = system->hasPlatformId(PlatformIds::ARCADE);
 
 		std::vector<std::string> hiddenExts;
 		for (auto ext : Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';'))
 			hiddenExts.push_back("." + Utils::String::toLower(ext));
 
-		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
-		for (auto& game : files)
+		for (auto game : system->getRootFolder()->getFilesRecursive(GAME))
 		{
 			if (system->isGroupSystem() && game->getSystem() != system)
 				continue;
 
-			bool include = includeFileInAutoCollections(game);
-			if (!include)
+			if (!includeFileInAutoCollections(game))
 				continue;
 
 			if (hiddenExts.size() > 0 && game->getType() == GAME)
@@ -996,86 +1173,73 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 					continue;
 			}
 
-			switch (sysDecl.type)
-			{
-			case AUTO_ALL_GAMES:
-				break;
-			case AUTO_VERTICALARCADE:
-				include = game->isVerticalArcadeGame();
-				break;
-			case AUTO_LIGHTGUN:
-				include = game->isLightGunGame();
-				break;
-			case AUTO_WHEEL:
-				include = game->isWheelGame();
-				break;
-			case AUTO_TRACKBALL:
-				include = game->isTrackballGame();
-				break;
-			case AUTO_SPINNER:
-				include = game->isSpinnerGame();
-				break;
-			case AUTO_RETROACHIEVEMENTS:
-				include = game->hasCheevos();
-				break;
-			case AUTO_LAST_PLAYED:
-				include = game->getMetadata(MetaDataId::PlayCount) > "0";
-				break;
-			case AUTO_NEVER_PLAYED:
-				include = !(game->getMetadata(MetaDataId::PlayCount) > "0");
-				break;
-			case AUTO_FAVORITES:
-				// we may still want to add files we don't want in auto collections in "favorites"
-				include = game->getFavorite();
-				break;
-			case AUTO_ARCADE:
-				include = isArcade;
-				break;
-			case AUTO_AT2PLAYERS: 
-			case AUTO_AT4PLAYERS:
-			{
-				std::string players = game->getMetadata(MetaDataId::Players);
-				if (players.empty())
-					include = false;
-				else
-				{
-					auto range = game->parsePlayersRange();
+			for (size_t i = 0; i < predicates.size(); i++)
+				if (predicates[i].matches(game, isArcade))
+					systemMatches[i].push_back(game);
+		}
+	};
 
-					int val = (sysDecl.type == AUTO_AT2PLAYERS ? 2 : 4);
-					include = range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
-				}
-			}
-			break;
+	if (systems.size() > 1 && Settings::getInstance()->getBool("ThreadedLoading"))
+	{
+		Utils::TaskGroup group(0, Utils::TaskScheduler::INTERACTIVE);
 
-			default:
-				if (!sysDecl.isCustom && !sysDecl.displayIfEmpty)
-				{
-					if (sysDecl.isGenreCollection())
-						include = Genres::genreExists(&game->getMetadata(), ((int)sysDecl.type) - 10000);
-					else if (sysDecl.isArcadeSubSystem())
-						include = isArcade && game->getMetadata(MetaDataId::ArcadeSystemName) == sysDecl.themeFolder;
-				}
+		for (size_t i = 0; i < systems.size(); i++)
+			group.run([&classifySystem, i] { classifySystem(i); });
 
-				break;
-			}
+		group.wait();
+	}
+	else
+	{
+		for (size_t i = 0; i < systems.size(); i++)
+			classifySystem(i);
+	}
+
+	for (size_t i = 0; i < collections.size(); i++)
+	{
+		CollectionSystemData* sysData = collections[i];
+
+		if (!createEntries)
+		{
+			sysData->games.clear();
+
+			for (auto& systemMatches : matches)
+				sysData->games.insert(sysData->games.end(), systemMatches[i].cbegin(), systemMatches[i].cend());
 
-			if (include)
+			sysData->games.shrink_to_fit();
+			sysData->isIndexed = true;
+			sysData->indexGeneration = generation;
+			continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(mAutoCollectionGamesLock);
+			sysData->games.clear();
+			sysData->games.shrink_to_fit();
+			sysData->isIndexed = false;
+		}
+
+		SystemData* newSys = sysData->system;
+		FolderData* rootFolder = newSys->getRootFolder();
+
+		for (auto& systemMatches : matches)
+		{
+			for (auto game : systemMatches[i])
 			{
 				CollectionFileData* newGame = new CollectionFileData(game, newSys);
 				rootFolder->addChild(newGame);
 				newSys->addToIndex(newGame);
 			}
 		}
-	}
 
-	if (sysDecl.type == AUTO_LAST_PLAYED)
-	{
-		sortLastPlayed(newSys);
-		trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
-	}
+		if (collections[i]->decl.type == AUTO_LAST_PLAYED)
+		{
+			sortLastPlayed(newSys);
+			trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
+		}
 
-	sysData->isPopulated = true;
-	updateCollectionFolderMetadata(newSys);
+		collections[i]->isPopulated = true;
+		updateCollectionFolderMetadata(newSys);
+	}
 }
 
 // populates a Custom Collection System
@@ -1098,10 +1262,7 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 		std::string indexPath = getFilteredCollectionPath(newSys->getName());
 		if (sysData->filteredIndex->load(indexPath))
 		{
-			FolderData* folder = getAllGamesCollection()->getRootFolder();
-
-			std::vector<FileData*> games = folder->getFilesRecursive(GAME);
-			for (auto game : games)
+			for (auto game : getAutoCollectionGames("all"))
 			{
 				if (sysData->filteredIndex->isSystemSelected(game->getSystemName()))
 					sysData->filteredIndex->addToIndex(game);
@@ -1135,13 +1296,11 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 	// get Configuration for this Custom System
 	std::ifstream input(path);
 
-	FolderData* folder = getAllGamesCollection()->getRootFolder();
-
 	std::unordered_map<std::string, FileData*> map;
 
-	if (pMap == nullptr && folder != nullptr)
+	if (pMap == nullptr)
 	{
-		folder->createChildrenByFilenameMap(map);
+		createAllGamesMap(map);
 		pMap = &map;
 	}
 
@@ -1213,21 +1372,42 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 
 		if (collectionsToPopulate.size() > 1)
 		{
-			getAllGamesCollection();
+			// Auto collections are filled together with a single pass over the games.
+			// Custom collections read the "all" index : make sure it's built before they run in parallel
+			getAutoCollectionGames("all");
+
+			std::vector<CollectionSystemData*> autoCollections;
+			for (auto collection : collectionsToPopulate)
+				if (!collection->decl.isCustom)
+					autoCollections.push_back(collection);
+
+			populateAutoCollections(autoCollections);
 
 			Utils::ThreadPool pool;
 
 			for (auto collection : collectionsToPopulate)
-			{
 				if (collection->decl.isCustom)
 					pool.queueWorkItem([this, collection, pMap] { populateCustomCollection(collection, pMap); });
-				else
-					pool.queueWorkItem([this, collection, pMap] { populateAutoCollection(collection); });
-			}
 
 			pool.wait();
 		}
 	}
+	else
+	{
+		std::vector<CollectionSystemData*> autoCollections;
+		for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
+			if (it->second.isEnabled && !it->second.isPopulated && !it->second.decl.isCustom)
+				autoCollections.push_back(&(it->second));
+
+		populateAutoCollections(autoCollections);
+	}
+
+	std::vector<SystemData*> themesToLoad;
+	for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
+		if (it->second.isEnabled && it->second.system->getTheme() == nullptr)
+			themesToLoad.push_back(it->second.system);
+
+	SystemData::loadThemes(themesToLoad);
 
 	// add auto enabled ones
 	for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
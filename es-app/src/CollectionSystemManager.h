@@ -3,6 +3,7 @@
 #define ES_APP_COLLECTION_SYSTEM_MANAGER_H
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -53,8 +54,15 @@ struct CollectionSystemData
 
 	CollectionFilter* filteredIndex;
 	bool isEnabled;
-	bool isPopulated;
+	bool isPopulated; // The CollectionFileData entries exist
 	bool needsSave;
+
+	// Auto collections only used internally ( "all", "arcade" ) keep their source games here, without creating any entry.
+	// Their content only depends on the tree and on the system visibility settings, which reload the whole manager when changed :
+	// the list is rebuilt on next use when games were added since it was built
+	bool isIndexed;
+	unsigned int indexGeneration; // FolderData tree generation when the list was built
+	std::vector<FileData*> games;
 };
 
 class CollectionSystemManager
@@ -76,7 +84,9 @@ public:
 	void updateSystemsList();
 
 	void refreshCollectionSystems(FileData* file);
+	void refreshCollectionSystems(const std::vector<FileData*>& files);
 	void updateCollectionSystem(FileData* file, const CollectionSystemData& sysData);
+	void updateCollectionSystem(const std::vector<FileData*>& files, const CollectionSystemData& sysData);
 	void deleteCollectionFiles(FileData* file);
 
 	inline std::map<std::string, CollectionSystemData>& getAutoCollectionSystems() { return mAutoCollectionSystemsData; };
@@ -94,6 +104,7 @@ public:
 
 	void reloadCollection(const std::string collectionName, bool repopulateGamelist = true);
     void populateAutoCollection(CollectionSystemData* sysData);
+	void populateAutoCollections(const std::vector<CollectionSystemData*>& collections, bool createEntries = true);
 	bool deleteCustomCollection(CollectionSystemData* data);
 
 	bool isCustomCollection(const std::string collectionName);
@@ -101,7 +112,8 @@ public:
 	
 	bool inInCustomCollection(FileData* file, const std::string collectionName);
 
-	SystemData* getArcadeCollection();
+	// Source games of an auto collection. Entries are only created if the collection is displayed
+	std::vector<FileData*> getAutoCollectionGames(const std::string& name);
 
 private:
 	static CollectionSystemManager* sInstance;
@@ -109,15 +121,16 @@ private:
 	std::map<std::string, CollectionSystemDecl> mCollectionSystemDeclsIndex;
 	std::map<std::string, CollectionSystemData> mAutoCollectionSystemsData;
 	std::map<std::string, CollectionSystemData> mCustomCollectionSystemsData;
+	std::mutex mAutoCollectionGamesLock; // CollectionSystemData::games of the auto collections
 	Window* mWindow;
 	
 	void initAutoCollectionSystems();
 	void initCustomCollectionSystems();
 		
-	SystemData* getAllGamesCollection();
 	SystemData* createNewCollectionEntry(std::string name, CollectionSystemDecl sysDecl, bool index = true, bool needSave = true);
 
 	void populateCustomCollection(CollectionSystemData* sysData, std::unordered_map<std::string, FileData*>* pMap = nullptr);
+	void createAllGamesMap(std::unordered_map<std::string, FileData*>& map);
 
 	void removeCollectionsFromDisplayedSystems();
 	void addEnabledCollectionsToDisplayedSystems(std::map<std::string, CollectionSystemData>* colSystemData, std::unordered_map<std::string, FileData*>* pMap);
@@ -6,6 +6,8 @@
 #include "AudioManager.h"
 #include "CollectionSystemManager.h"
 #include "FileFilterIndex.h"
+#include "NetPlayIndex.h"
+#include "services/GameIdIndex.h"
 #include "FileSorts.h"
 #include "Log.h"
 #include "MameNames.h"
@@ -23,6 +25,7 @@
 #include "ApiSystem.h"
 #include <time.h>
 #include <algorithm>
+#include <mutex>
 #include "LangParser.h"
 #include "resources/ResourceManager.h"
 #include "RetroAchievements.h"
@@ -33,6 +36,7 @@
 #include "guis/GuiMsgBox.h"
 #include "Paths.h"
 #include "resources/TextureData.h"
+#include "resources/TextureResource.h"
 
 using namespace Utils::Platform;
 
@@ -60,6 +64,7 @@ static std::map<std::string, std::function<BindableProperty(FileData*)>> propert
 };
 
 FileData* FileData::mRunningGame = nullptr;
+std::atomic<unsigned int> FolderData::mTreeGeneration(0);
 
 FileData::FileData(FileType type, const std::string& path, SystemData* system)
 	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
@@ -138,7 +143,11 @@ FileData::~FileData()
 		mParent->removeChild(this);
 
 	if (mType == GAME)
+	{
 		mSystem->removeFromIndex(this);
+		NetPlayIndex::remove(this);
+		GameIdIndex::remove(this);
+	}
 }
 
 std::string& FileData::getDisplayName()
@@ -703,6 +712,11 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 	VolumeControl::getInstance()->deinit();
 
 	bool hideWindow = Settings::getInstance()->getBool("HideWindow");
+	bool fullReinit = !hideWindow && Settings::getInstance()->getBool("HideWindowFullReinit");
+
+	// Keep what's on screen in RAM, so that it's back at once after the game
+	TextureResource::suspend((size_t)Settings::GameReturnCacheSize() * 1024 * 1024);
+
 	window->deinit(hideWindow);
 	
 	const std::string rom = Utils::FileSystem::getEscapedPath(getPath());
@@ -740,18 +754,27 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 	Scripting::fireEvent("game-end");
 	
-	if (!hideWindow && Settings::getInstance()->getBool("HideWindowFullReinit"))
 	{
-		ResourceManager::getInstance()->reloadAll();
-		window->deinit();
-		window->init();
-		window->setCustomSplashScreen(gameToUpdate->getImagePath(), gameToUpdate->getName(), gameToUpdate);
-	}
-	else
-		window->init(hideWindow);
+		StopWatch returnToUi("Return to UI :", LogInfo);
+
+		if (fullReinit)
+		{
+			// The copies are for the renderer created by init : the reload that precedes it would only consume them
+			TextureResource::holdSnapshots(true);
+			ResourceManager::getInstance()->reloadAll();
+			window->deinit();
+			TextureResource::holdSnapshots(false);
+			window->init();
+			window->setCustomSplashScreen(gameToUpdate->getImagePath(), gameToUpdate->getName(), gameToUpdate);
+		}
+		else
+			window->init(hideWindow);
 
-	VolumeControl::getInstance()->init();
-	AudioManager::getInstance()->init();
+		TextureResource::resume();
+
+		VolumeControl::getInstance()->init();
+		AudioManager::getInstance()->init();
+	}
 
 	window->normalizeNextUpdate();
 
@@ -997,85 +1020,249 @@ const std::string& CollectionFileData::getName()
 	return mSourceFileData->getName();
 }
 
+// Above this amount of changed items, the display list is recomputed instead of being patched
+#define DISPLAYLIST_MAX_PATCHES 16
+
+static std::recursive_mutex _displayListLock;
+
 const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
 {
-	std::vector<FileData*> ret;
-
-	std::string showFoldersMode = getSystem()->getFolderViewMode();
+	DisplayListCache key;
+	key.folderViewMode = getSystem()->getFolderViewMode();
 	
-	bool showHiddenFiles = Settings::ShowHiddenFiles();
+	key.showHiddenFiles = Settings::ShowHiddenFiles();
 
 	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHiddenFiles = true;
-	else if (shv == "0") showHiddenFiles = false;
+	if (shv == "1") key.showHiddenFiles = true;
+	else if (shv == "0") key.showHiddenFiles = false;
 
-	bool filterKidGame = false;
+	key.filterKidGame = false;
 
 	if (!Settings::getInstance()->getBool("ForceDisableFilters"))
 	{
 		if (UIModeController::getInstance()->isUIModeKiosk())
-			showHiddenFiles = false;
+			key.showHiddenFiles = false;
 
 		if (UIModeController::getInstance()->isUIModeKid())
-			filterKidGame = true;
+			key.filterKidGame = true;
 	}
 
 	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
+	key.system = sys;
 
-	std::vector<std::string> hiddenExts;
 	if (mSystem->isGameSystem() && !mSystem->isCollection())
-		hiddenExts = Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt")), ';');
+		key.hiddenExts = Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt"));
+
+	std::vector<std::string> hiddenExts;
+	if (!key.hiddenExts.empty())
+		hiddenExts = Utils::String::split(key.hiddenExts, ';');
 
 	FileFilterIndex* idx = sys->getIndex(false);
 	if (idx != nullptr && !idx->isFiltered())
 		idx = nullptr;
 
-  	std::vector<FileData*>* items = &mChildren;
-	
-	std::vector<FileData*> flatGameList;
-	if (showFoldersMode == "never")
-	{
-		flatGameList = getFlatGameList(false, sys);
-		items = &flatGameList;		
-	}
+	key.filterIndex = idx;
+	key.filterGeneration = FileFilterIndex::getFilterGeneration();
 
-	std::map<FileData*, int> scoringBoard;
+	key.sortId = sys->getSortId();
+	if (key.sortId > FileSorts::getSortTypes().size())
+		key.sortId = 0;
 
-	bool refactorUniqueGameFolders = (showFoldersMode == "having multiple games");
+	key.foldersFirst = Settings::ShowFoldersFirst();
+	key.favoritesFirst = getSystem()->getShowFavoritesFirst();
 
-	for (auto it = items->cbegin(); it != items->cend(); it++)
+	// Read before looking at the items : anything changed from now on will be seen next time
+	key.generation = MetaDataList::getGlobalGeneration();
+
+	if (key.folderViewMode == "never")
+		key.items = getFlatGameList(false, sys);
+	else
+		key.items = mChildren;
+
+	bool refactorUniqueGameFolders = (key.folderViewMode == "having multiple games");
+
+	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(key.sortId);
+	bool relevancy = (idx != nullptr && idx->hasRelevency());
+
+	// Returns 0 if the item is not displayed, otherwise its filter score
+	auto scoreItem = [&](FileData* item) -> int
 	{
-		if (!showHiddenFiles && (*it)->getHidden())
-			continue;
+		if (!key.showHiddenFiles && item->getHidden())
+			return 0;
 
-		if (filterKidGame && (*it)->getType() == GAME && !(*it)->getKidGame())
-			continue;
+		if (key.filterKidGame && item->getType() == GAME && !item->getKidGame())
+			return 0;
 
-		if (hiddenExts.size() > 0 && (*it)->getType() == GAME)
+		if (hiddenExts.size() > 0 && item->getType() == GAME)
 		{
-			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension((*it)->getFileName(), false));
+			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(item->getFileName(), false));
 			if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
-				continue;
+				return 0;
 		}
 
 		if (idx != nullptr)
+			return idx->showFile(item);
+
+		return 1;
+	};
+
+	std::unique_lock<std::recursive_mutex> lock(_displayListLock);
+
+	DisplayListCache* cache = mDisplayListCache.get();
+
+	// Same keys as FileSorts::sortFiles, so patched items land where a full sort would put them.
+	// Computed once per item : some need a file system access ( creation date )
+	std::unordered_map<FileData*, std::string> sortKeys;
+
+	auto sortKey = [&sortKeys, &sort](FileData* file) -> const std::string&
+	{
+		auto it = sortKeys.find(file);
+		if (it == sortKeys.cend())
+			it = sortKeys.emplace(file, FileSorts::getSortKey(file, sort.id)).first;
+
+		return it->second;
+	};
+
+	// Returns < 0 if file1 goes before file2, > 0 if after, 0 if the sort keeps their source order
+	auto compare = [&cache, &sort, &sortKey, relevancy](FileData* file1, FileData* file2) -> int
+	{
+		if (relevancy)
 		{
-			int score = idx->showFile(*it);
+			auto s1 = cache->scores.find(file1);
+			auto s2 = cache->scores.find(file2);
+
+			if (s1 != cache->scores.cend() && s2 != cache->scores.cend() && s1->second != s2->second)
+				return s1->second < s2->second ? -1 : 1;
+
+			if (sort.comparisonFunction(file1, file2))
+				return -1;
+
+			return sort.comparisonFunction(file2, file1) ? 1 : 0;
+		}
+
+		if (cache->favoritesFirst && file1->getFavorite() != file2->getFavorite())
+			return file1->getFavorite() ? -1 : 1;
+
+		if (cache->foldersFirst && file1->getType() != file2->getType())
+			return (file1->getType() == FOLDER) ? -1 : 1;
+
+		int cmp = sortKey(file1).compare(sortKey(file2));
+		if (cmp == 0)
+			return 0;
+
+		return ((cmp < 0) == sort.ascending) ? -1 : 1;
+	};
+
+	if (cache != nullptr && cache->sameKey(key) && cache->items == key.items)
+	{
+		std::vector<FileData*> changed;
+		bool rebuild = false;
+
+		for (auto item : key.items)
+		{
+			if (item->getType() == FOLDER && refactorUniqueGameFolders)
+			{
+				// The folder may be displayed as its unique game : any change inside requires a full rebuild
+				for (auto game : ((FolderData*)item)->getFilesRecursive(GAME))
+					if (game->getMetadata().getGeneration() > cache->generation)
+						rebuild = true;
+			}
+
+			if (item->getMetadata().getGeneration() <= cache->generation)
+				continue;
+
+			if (item->getType() != GAME || changed.size() >= DISPLAYLIST_MAX_PATCHES)
+				rebuild = true;
+
+			changed.push_back(item);
+		}
+
+		// Both sorts are stable : equal items stay in the order of the source items
+		std::unordered_map<FileData*, size_t> positions;
+
+		// Remove all changed items first : the others still sit at their old place, the list would not be sorted
+		for (size_t i = 0; !rebuild && i < changed.size(); i++)
+		{
+			auto it = std::find(cache->list.begin(), cache->list.end(), changed[i]);
+			if (it != cache->list.end())
+				cache->list.erase(it);
+
+			cache->scores.erase(changed[i]);
+		}
+
+		for (size_t i = 0; !rebuild && i < changed.size(); i++)
+		{
+			FileData* item = changed[i];
+
+			int score = scoreItem(item);
 			if (score == 0)
 				continue;
 
-			scoringBoard[*it] = score;
+			if (idx != nullptr)
+				cache->scores[item] = score;
+
+			auto at = std::partition_point(cache->list.begin(), cache->list.end(), [&](FileData* other)
+			{
+				int cmp = compare(other, item);
+				if (cmp != 0)
+					return cmp < 0;
+
+				if (positions.empty())
+					for (size_t pos = 0; pos < key.items.size(); pos++)
+						positions[key.items[pos]] = pos;
+
+				auto p1 = positions.find(other);
+				auto p2 = positions.find(item);
+
+				// A folder displayed as its unique game has no source position here
+				if (p1 == positions.cend() || p2 == positions.cend())
+				{
+					rebuild = true;
+					return false;
+				}
+
+				return p1->second < p2->second;
+			});
+
+			if (!rebuild)
+				cache->list.insert(at, item);
 		}
 
-		if ((*it)->getType() == FOLDER && refactorUniqueGameFolders)
+		if (!rebuild)
 		{
-			FolderData* pFolder = (FolderData*)(*it);
+			cache->generation = key.generation;
+			return cache->list;
+		}
+	}
+
+	if (cache == nullptr)
+	{
+		mDisplayListCache = std::unique_ptr<DisplayListCache>(new DisplayListCache());
+		cache = mDisplayListCache.get();
+	}
+
+	*cache = key;
+
+	std::vector<FileData*>& ret = cache->list;
+
+	for (auto item : cache->items)
+	{
+		int score = scoreItem(item);
+		if (score == 0)
+			continue;
+
+		if (idx != nullptr)
+			cache->scores[item] = score;
+
+		if (item->getType() == FOLDER && refactorUniqueGameFolders)
+		{
+			FolderData* pFolder = (FolderData*)item;
 			if (pFolder->getChildren().size() == 0)
 				continue;
 
 			if (pFolder->isVirtualStorage() && pFolder->getSourceFileData()->getSystem()->isGroupChildSystem() && pFolder->getSourceFileData()->getSystem()->getName() == "windows_installers")
 			{
-				ret.push_back(*it);
+				ret.push_back(item);
 				continue;
 			}
 
@@ -1085,10 +1272,10 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 				if (idx != nullptr && !idx->showFile(fd))
 					continue;
 
-				if (!showHiddenFiles && fd->getHidden())
+				if (!key.showHiddenFiles && fd->getHidden())
 					continue;
 
-				if (filterKidGame && !fd->getKidGame())
+				if (key.filterKidGame && !fd->getKidGame())
 					continue;
 
 				ret.push_back(fd);
@@ -1097,46 +1284,13 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 			}
 		}
 
-		ret.push_back(*it);
+		ret.push_back(item);
 	}
 
-	unsigned int currentSortId = sys->getSortId();
-	if (currentSortId > FileSorts::getSortTypes().size())
-		currentSortId = 0;
-
-	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(currentSortId);
-
-	if (idx != nullptr && idx->hasRelevency())
-	{
-		auto compf = sort.comparisonFunction;
-
-		std::sort(ret.begin(), ret.end(), [scoringBoard, compf](const FileData* file1, const FileData* file2) -> bool
-		{ 
-			auto s1 = scoringBoard.find((FileData*) file1);
-			auto s2 = scoringBoard.find((FileData*) file2);		
-
-			if (s1 != scoringBoard.cend() && s2 != scoringBoard.cend() && s1->second != s2->second)
-				return s1->second < s2->second;
-			
-			return compf(file1, file2);
-		});
-	}
+	if (relevancy)
+		std::stable_sort(ret.begin(), ret.end(), [&compare](FileData* file1, FileData* file2) { return compare(file1, file2) < 0; });
 	else
-	{
-		bool foldersFirst = Settings::ShowFoldersFirst();
-		bool favoritesFirst = getSystem()->getShowFavoritesFirst();
-
-		std::stable_sort(ret.begin(), ret.end(), [sort, foldersFirst, favoritesFirst](const FileData* file1, const FileData* file2) -> bool
-			{
-				if (favoritesFirst && file1->getFavorite() != file2->getFavorite())
-					return file1->getFavorite();
-
-				if (foldersFirst && file1->getType() != file2->getType())
-					return (file1->getType() == FOLDER);
-
-				return sort.comparisonFunction(file1, file2) == sort.ascending;
-			});
-	}
+		FileSorts::sortFiles(ret, sort.id, key.foldersFirst, key.favoritesFirst);
 
 	return ret;
 }
@@ -1311,6 +1465,9 @@ void FolderData::addChild(FileData* file, bool assignParent)
 
 	mChildren.push_back(file);
 
+	if (file->getSourceFileData() == file)
+		mTreeGeneration++;
+
 	if (assignParent)
 		file->setParent(this);	
 }
@@ -15,6 +15,7 @@
 #include "BindingManager.h"
 
 class Window;
+class FileFilterIndex;
 struct SystemEnvironmentData;
 
 
@@ -261,9 +262,43 @@ public:
 	void removeVirtualFolders();
 	void removeFromVirtualFolders(FileData* game);
 
+	// Bumped each time a file is added to a folder, collection entries excepted : indexes over the tree compare it to know that games appeared
+	static unsigned int getTreeGeneration() { return mTreeGeneration; }
+
 private:
+	static std::atomic<unsigned int> mTreeGeneration;
+
 	void getFilesRecursiveWithContext(std::vector<FileData*>& out, unsigned int typeMask, GetFileContext* filter, bool displayedOnly, SystemData* system, bool includeVirtualStorage) const;
 
+	// Last result of getChildrenListToDisplay, and everything it depends on.
+	// It's reused while the key matches and the candidate items are the same. Items whose metadata changed since are patched in place.
+	struct DisplayListCache
+	{
+		std::string  folderViewMode;
+		std::string  hiddenExts;
+		bool         showHiddenFiles;
+		bool         filterKidGame;
+		bool         foldersFirst;
+		bool         favoritesFirst;
+		unsigned int sortId;
+		SystemData*  system;
+		FileFilterIndex* filterIndex;
+		unsigned int filterGeneration;
+
+		unsigned int generation; // MetaDataList global generation when the list was computed
+		std::vector<FileData*> items;
+		std::vector<FileData*> list;
+		std::unordered_map<FileData*, int> scores;
+
+		bool sameKey(const DisplayListCache& other) const
+		{
+			return folderViewMode == other.folderViewMode && hiddenExts == other.hiddenExts && showHiddenFiles == other.showHiddenFiles && filterKidGame == other.filterKidGame &&
+				foldersFirst == other.foldersFirst && favoritesFirst == other.favoritesFirst && sortId == other.sortId && system == other.system &&
+				filterIndex == other.filterIndex && filterGeneration == other.filterGeneration;
+		}
+	};
+
+	std::unique_ptr<DisplayListCache> mDisplayListCache;
 
 	std::vector<FileData*> mChildren;
 	bool	mOwnsChildrens;
@@ -18,6 +18,8 @@
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
+unsigned int FileFilterIndex::mFilterGeneration = 0;
+
 FileFilterIndex::FileFilterIndex()
 	: filterByFavorites(false), filterByGenre(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false), filterByYear(false)
 	, filterByLightGun(false), filterByWheel(false), filterByTrackball(false), filterBySpinner(false), filterByVertical(false), filterByCheevos(false), filterByPlayed(false), filterByRegion(false), filterByLang(false), filterByFamily(false), filterByHasMedia(false), filterByMissingMedia(false)
@@ -92,6 +94,8 @@ void FileFilterIndex::copyFrom(FileFilterIndex* indexToImport)
 
 		*src->second.filteredByRef = *decl.second.filteredByRef;
 	}
+
+	mFilterGeneration++;
 }
 
 void FileFilterIndex::importIndex(FileFilterIndex* indexToImport)
@@ -461,6 +465,8 @@ void FileFilterIndex::removeFromIndex(FileData* game)
 
 void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>* values)
 {
+	mFilterGeneration++;
+
 	// test if it exists before setting
 	if(type == NONE)
 	{
@@ -500,6 +506,8 @@ std::unordered_set<std::string>* FileFilterIndex::getFilter(FilterIndexType type
 
 void FileFilterIndex::clearAllFilters()
 {
+	mFilterGeneration++;
+
 	mUseRelevency = false;
 	mTextFilter = "";
 
@@ -520,6 +528,8 @@ void FileFilterIndex::resetFilters()
 
 void FileFilterIndex::setUIModeFilters()
 {
+	mFilterGeneration++;
+
 	if (Settings::getInstance()->getBool("ForceDisableFilters"))
 		return;
 	
@@ -533,6 +543,8 @@ void FileFilterIndex::setUIModeFilters()
 
 void FileFilterIndex::setTextFilter(const std::string text, bool useRelevancy) 
 { 
+	mFilterGeneration++;
+
 	mTextFilter = text;
 	mUseRelevency = useRelevancy;
 }
@@ -1089,6 +1101,8 @@ void FileFilterIndex::clearIndex(std::map<std::string, int> indexMap)
 
 bool CollectionFilter::create(const std::string name)
 {
+	mFilterGeneration++;
+
 	mName = name;
 	mPath = getCollectionsFolder() + "/" + mName + ".xcc";
 	return save();
@@ -1096,6 +1110,8 @@ bool CollectionFilter::create(const std::string name)
 
 bool CollectionFilter::createFromSystem(const std::string name, SystemData* system)
 {
+	mFilterGeneration++;
+
 	FileFilterIndex* filter = system->getFilterIndex();
 	if (filter == nullptr)
 		return false;
@@ -1124,6 +1140,8 @@ bool CollectionFilter::createFromSystem(const std::string name, SystemData* syst
 
 bool CollectionFilter::load(const std::string file)
 {
+	mFilterGeneration++;
+
 	if (!Utils::FileSystem::exists(file))
 		return false;
 
@@ -1327,6 +1345,8 @@ bool CollectionFilter::isSystemSelected(const std::string name)
 
 void CollectionFilter::setSystemSelected(const std::string name, bool value)
 {
+	mFilterGeneration++;
+
 	auto sys = mSystemFilter.find(name);
 	if (sys == mSystemFilter.cend())
 	{
@@ -1339,6 +1359,8 @@ void CollectionFilter::setSystemSelected(const std::string name, bool value)
 
 void CollectionFilter::resetSystemFilter()
 {
+	mFilterGeneration++;
+
 	mSystemFilter.clear();
 }
 
@@ -84,6 +84,9 @@ public:
 	inline const std::string getTextFilter() { return mTextFilter; }
 	inline bool hasRelevency() { return !mTextFilter.empty() && mUseRelevency; }
 
+	// Changes each time a filter of any index changes
+	static unsigned int getFilterGeneration() { return mFilterGeneration; }
+
 	std::string getDisplayLabel(bool includeText = false);
 
 protected:
@@ -166,6 +169,8 @@ protected:
 
 	std::string mTextFilter;
 	bool		mUseRelevency;
+
+	static unsigned int mFilterGeneration;
 };
 
 class CollectionFilter : public FileFilterIndex
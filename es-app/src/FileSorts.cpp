@@ -2,7 +2,12 @@
 #include "FileSorts.h"
 
 #include "utils/StringUtil.h"
+#include "utils/TaskScheduler.h"
 #include "LocaleES.h"
+#include <algorithm>
+
+// Above this amount of files, sort keys are computed in parallel
+#define PARALLEL_SORTKEYS_MIN 4096
 
 namespace FileSorts
 {
@@ -223,4 +228,182 @@ namespace FileSorts
 		std::string system2 = ((FileData*)file2)->getSourceFileData()->getSystemName();
 		return Utils::String::compareIgnoreCase(system1, system2) < 0;		
 	}
+
+	static void appendInt(std::string& key, int value)
+	{
+		unsigned int v = ((unsigned int)value) ^ 0x80000000;
+		for (int i = 3; i >= 0; i--)
+			key.push_back((char)((v >> (i * 8)) & 0xFF));
+	}
+
+	static void appendFloat(std::string& key, float value)
+	{
+		unsigned int v;
+		memcpy(&v, &value, sizeof(v));
+
+		// Flip negatives entirely, and the sign of positives : the bits then sort like the values
+		v = (v & 0x80000000) ? ~v : (v | 0x80000000);
+		for (int i = 3; i >= 0; i--)
+			key.push_back((char)((v >> (i * 8)) & 0xFF));
+	}
+
+	// Separates collation key fields : collation keys never contain a zero code point
+	static void appendSeparator(std::string& key)
+	{
+		key.append(3, '\0');
+	}
+
+	static std::string getNameKey(FileData* file)
+	{
+		if (Settings::IgnoreLeadingArticles())
+		{
+			static auto articles = Utils::String::commaStringToVector(_("A,AN,THE"));
+			return Utils::String::collationKey(stripLeadingArticle(file->getName(), articles));
+		}
+
+		return Utils::String::collationKey(file->getName());
+	}
+
+	std::string getSortKey(FileData* file, int sortId)
+	{
+		std::string key;
+
+		switch (sortId)
+		{
+		case FILENAME_ASCENDING:
+		case FILENAME_DESCENDING:
+			return getNameKey(file);
+
+		case RATING_ASCENDING:
+		case RATING_DESCENDING:
+			appendFloat(key, file->getMetadata().getFloat(MetaDataId::Rating));
+			return key;
+
+		// Only games have these : other entries keep an empty key and group before the games ( after them when descending ).
+		// The former comparators made a folder equal to everything, which is no ordering at all for a sort.
+		case TIMESPLAYED_ASCENDING:
+		case TIMESPLAYED_DESCENDING:
+			if (file->getMetadata().getType() == GAME_METADATA)
+				appendInt(key, file->getMetadata().getInt(MetaDataId::PlayCount));
+			return key;
+
+		case GAMETIME_ASCENDING:
+		case GAMETIME_DESCENDING:
+			if (file->getMetadata().getType() == GAME_METADATA)
+				appendInt(key, file->getMetadata().getInt(MetaDataId::GameTime));
+			return key;
+
+		case LASTPLAYED_ASCENDING:
+		case LASTPLAYED_DESCENDING:
+			// ISO strings (YYYYMMDDTHHMMSS) already sort like dates
+			return file->getMetadata().get(MetaDataId::LastPlayed);
+
+		case RELEASEDATE_ASCENDING:
+		case RELEASEDATE_DESCENDING:
+			return file->getMetadata().get(MetaDataId::ReleaseDate);
+
+		case NUMBERPLAYERS_ASCENDING:
+		case NUMBERPLAYERS_DESCENDING:
+			appendInt(key, file->getMetadata().getInt(MetaDataId::Players));
+			return key;
+
+		case GENRE_ASCENDING:
+		case GENRE_DESCENDING:
+			return Utils::String::collationKey(file->getMetadata().get(MetaDataId::Genre));
+
+		case DEVELOPER_ASCENDING:
+		case DEVELOPER_DESCENDING:
+			return Utils::String::collationKey(file->getMetadata().get(MetaDataId::Developer));
+
+		case PUBLISHER_ASCENDING:
+		case PUBLISHER_DESCENDING:
+			return Utils::String::collationKey(file->getMetadata().get(MetaDataId::Publisher));
+
+		case SYSTEM_ASCENDING:
+		case SYSTEM_DESCENDING:
+			return Utils::String::collationKey(file->getSourceFileData()->getSystemName());
+
+		case FILECREATION_DATE_ASCENDING:
+		case FILECREATION_DATE_DESCENDING:
+			return Utils::FileSystem::getFileCreationDate(file->getPath()).getIsoString();
+
+		case SYSTEM_RELEASEDATE_ASCENDING:
+		case SYSTEM_RELEASEDATE_DESCENDING:
+			key = Utils::String::collationKey(file->getSourceFileData()->getSystemName());
+			appendSeparator(key);
+			key += Utils::String::collationKey(file->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4), false);
+			appendSeparator(key);
+			key += Utils::String::collationKey(file->getName(), false);
+			return key;
+
+		case RELEASEDATE_SYSTEM_ASCENDING:
+		case RELEASEDATE_SYSTEM_DESCENDING:
+			key = Utils::String::collationKey(file->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4), false);
+			appendSeparator(key);
+			key += Utils::String::collationKey(file->getSourceFileData()->getSystemName());
+			appendSeparator(key);
+			key += Utils::String::collationKey(file->getName(), false);
+			return key;
+		}
+
+		return getNameKey(file);
+	}
+
+	struct SortEntry
+	{
+		int group;
+		std::string key;
+		FileData* file;
+	};
+
+	void sortFiles(std::vector<FileData*>& files, int sortId, bool foldersFirst, bool favoritesFirst)
+	{
+		if (files.size() < 2)
+			return;
+
+		bool ascending = getSortType(sortId).ascending;
+
+		std::vector<SortEntry> entries(files.size());
+
+		auto computeKeys = [&entries, &files, sortId, foldersFirst, favoritesFirst](size_t from, size_t to)
+		{
+			for (size_t i = from; i < to; i++)
+			{
+				FileData* file = files[i];
+
+				entries[i].file = file;
+				entries[i].group = ((favoritesFirst && !file->getFavorite()) ? 2 : 0) + ((foldersFirst && file->getType() != FOLDER) ? 1 : 0);
+				entries[i].key = getSortKey(file, sortId);
+			}
+		};
+
+		if (files.size() >= PARALLEL_SORTKEYS_MIN)
+		{
+			Utils::TaskGroup group(0, Utils::TaskScheduler::INTERACTIVE);
+
+			size_t chunks = (size_t)Utils::TaskScheduler::getWorkerCount();
+			size_t chunkSize = (files.size() + chunks - 1) / chunks;
+
+			for (size_t from = 0; from < files.size(); from += chunkSize)
+			{
+				size_t to = std::min(from + chunkSize, files.size());
+				group.run([&computeKeys, from, to] { computeKeys(from, to); });
+			}
+
+			group.wait();
+		}
+		else
+			computeKeys(0, files.size());
+
+		std::stable_sort(entries.begin(), entries.end(), [ascending](const SortEntry& e1, const SortEntry& e2)
+		{
+			if (e1.group != e2.group)
+				return e1.group < e2.group;
+
+			return ascending ? e1.key < e2.key : e2.key < e1.key;
+		});
+
+		for (size_t i = 0; i < entries.size(); i++)
+			files[i] = entries[i].file;
+	}
 };
@@ -83,5 +83,11 @@ namespace FileSorts
 	bool compareReleaseYearSystem(const FileData* file1, const FileData* file2);
 
 	std::string stripLeadingArticle(const std::string &string, const std::vector<std::string> &articles);
+
+	// Binary key giving the same order as the sort's comparison function, when compared as a string
+	std::string getSortKey(FileData* file, int sortId);
+
+	// Sorts by precomputed keys : each key is computed once per file instead of once per comparison
+	void sortFiles(std::vector<FileData*>& files, int sortId, bool foldersFirst = false, bool favoritesFirst = false);
 };
 #endif // ES_APP_FILE_SORTS_H
@@ -10,6 +10,15 @@
 #include <pugixml/src/pugixml.hpp>
 #include "Genres.h"
 #include "Paths.h"
+#include "GamelistJournal.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+#include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -106,28 +115,96 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 	return NULL;
 }
 
-std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
-{	
-	std::vector<FileData*> ret;
+static bool readGamelistBuffer(const std::string& path, std::string& buffer)
+{
+	std::ifstream in(WINSTRINGW(path), std::ios::binary);
+	if (!in)
+		return false;
 
-	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+	in.seekg(0, std::ios::end);
+	std::streamoff size = in.tellg();
+	if (size < 0)
+		return false;
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result result = fromFile ? doc.load_file(WINSTRINGW(xmlpath).c_str()) : doc.load_string(xmlpath.c_str());
+	buffer.resize((size_t)size);
+	in.seekg(0, std::ios::beg);
+	return size == 0 || (bool)in.read(&buffer[0], size);
+}
 
-	if (!result)
+// Returns the beginning of the line if offset is only preceded by indentation, so that entries keep their formatting when spliced
+static size_t getLineStart(const std::string& buffer, size_t offset)
+{
+	size_t pos = offset;
+	while (pos > 0 && (buffer[pos - 1] == ' ' || buffer[pos - 1] == '\t'))
+		pos--;
+
+	if (pos > 0 && buffer[pos - 1] == '\n')
+		return pos;
+
+	return offset;
+}
+
+static std::shared_ptr<GamelistIndex> createGamelistIndex(const std::string& buffer, pugi::xml_node& root, const std::string& relativeTo)
+{
+	size_t closingTag = buffer.rfind("</gameList>");
+	if (closingTag == std::string::npos)
+		return nullptr;
+
+	std::vector<std::pair<size_t, std::string>> nodes;
+
+	for (pugi::xml_node fileNode : root.children())
 	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return ret;
+		if (fileNode.type() != pugi::node_element)
+			continue;
+
+		ptrdiff_t offset = fileNode.offset_debug();
+		if (offset <= 0 || (size_t)offset >= buffer.size() || buffer[offset - 1] != '<')
+			return nullptr;
+
+		size_t start = getLineStart(buffer, offset - 1);
+		if (nodes.size() > 0 && start <= nodes.back().first)
+			return nullptr;
+
+		std::string path;
+
+		std::string tag = fileNode.name();
+		if (tag == "game" || tag == "folder")
+		{
+			pugi::xml_node pathNode = fileNode.child("path");
+			if (pathNode)
+				path = Utils::FileSystem::resolveRelativePath(pathNode.text().get(), relativeTo, false);
+		}
+
+		nodes.push_back(std::make_pair(start, path));
 	}
 
-	pugi::xml_node root = doc.child("gameList");
-	if (!root)
+	auto index = std::make_shared<GamelistIndex>();
+	index->fileSize = buffer.size();
+	index->closingTag = getLineStart(buffer, closingTag);
+
+	if (nodes.size() > 0 && nodes.back().first >= index->closingTag)
+		return nullptr;
+
+	for (size_t i = 0; i < nodes.size(); i++)
 	{
-		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
-		return ret;
+		if (nodes[i].second.empty())
+			continue;
+
+		GamelistIndex::Range range;
+		range.start = nodes[i].first;
+		range.end = (i + 1 < nodes.size() ? nodes[i + 1].first : index->closingTag);
+
+		// In case of duplicates, the last entry is the one that wins when loading : keep track of that one
+		index->entries[nodes[i].second] = range;
 	}
 
+	return index;
+}
+
+std::vector<FileData*> loadGamelistNodes(pugi::xml_node& root, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
+{
+	std::vector<FileData*> ret;
+
 	if (checkSize != SIZE_MAX)
 	{
 		auto parentSize = root.attribute("parentHash").as_uint();
@@ -208,10 +285,32 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 	return ret;
 }
 
+std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
+{	
+	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = fromFile ? doc.load_file(WINSTRINGW(xmlpath).c_str()) : doc.load_string(xmlpath.c_str());
+
+	if (!result)
+	{
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		return std::vector<FileData*>();
+	}
+
+	pugi::xml_node root = doc.child("gameList");
+	if (!root)
+	{
+		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
+		return std::vector<FileData*>();
+	}
+
+	return loadGamelistNodes(root, system, fileMap, checkSize, fromFile);
+}
+
 void clearTemporaryGamelistRecovery(SystemData* system)
 {	
-	auto path = getGamelistRecoveryPath(system);
-	Utils::FileSystem::deleteDirectoryFiles(path, true);
+	GamelistJournal::compact(system->getName(), GamelistJournal::rotate(system));
 }
 
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
@@ -220,11 +319,52 @@ void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*
 
 	auto size = Utils::FileSystem::getFileSize(xmlpath);
 	if (size != 0)
-		loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true);
+	{
+		LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
 
-	auto files = Utils::FileSystem::getDirContent(getGamelistRecoveryPath(system), true);
-	for (auto file : files)
-		loadGamelistFile(file, system, fileMap, size, true);
+		// Parse from our own buffer : node offsets are kept in the GamelistIndex so updateGamelist won't have to parse it again
+		std::string buffer;
+		pugi::xml_document doc;
+		pugi::xml_parse_result result;
+
+		if (readGamelistBuffer(xmlpath, buffer))
+			result = doc.load_buffer(buffer.data(), buffer.size());
+
+		pugi::xml_node root = doc.child("gameList");
+
+		if (!result)
+			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		else if (!root)
+			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
+		else
+		{
+			loadGamelistNodes(root, system, fileMap, SIZE_MAX, true);
+			system->setGamelistIndex(createGamelistIndex(buffer, root, system->getStartPath()));
+		}
+	}
+
+	// Recovery files written by previous versions : move them to the journal
+	std::vector<std::string> legacyFiles;
+	for (auto file : Utils::FileSystem::getDirContent(getGamelistRecoveryPath(system), true))
+	{
+		if (Utils::String::toLower(Utils::FileSystem::getExtension(file)) != ".xml")
+			continue;
+
+		for (auto game : loadGamelistFile(file, system, fileMap, size, true))
+			GamelistJournal::append(game);
+
+		legacyFiles.push_back(file);
+	}
+
+	if (legacyFiles.size())
+	{
+		GamelistJournal::flush();
+
+		for (auto file : legacyFiles)
+			Utils::FileSystem::removeFile(file);
+	}
+
+	GamelistJournal::replay(system, fileMap);
 
 	if (size != SIZE_MAX)
 		system->setGamelistHash(size);	
@@ -301,36 +441,12 @@ bool saveToGamelistRecovery(FileData* file)
 		return false;
 
 	SystemData* system = file->getSourceFileData()->getSystem();
-	if (!Settings::HiddenSystemsShowGames() && !system->isVisible())
+	if (system == nullptr || (!Settings::HiddenSystemsShowGames() && !system->isVisible()))
 		return false;
 
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
-
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
-	return saveToXml(file, path);
-}
-
-bool removeFromGamelistRecovery(FileData* file)
-{
-	SystemData* system = file->getSourceFileData()->getSystem();
-	if (system == nullptr)
-		return false;
-
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
-
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
-	if (Utils::FileSystem::exists(path))
-		return Utils::FileSystem::removeFile(path);
-
-	return false;
+	// Only the metadata changed since the last call are appended : the journal is compacted once gamelist.xml is written
+	GamelistJournal::append(file);
+	return true;
 }
 
 bool hasDirtyFile(SystemData* system)
@@ -349,12 +465,373 @@ bool hasDirtyFile(SystemData* system)
 	return false;
 }
 
-void updateGamelist(SystemData* system)
+struct GamelistChange
+{
+	std::string path; // GamelistIndex key
+	std::string xml;  // Serialized node, empty if the entry has to be removed
+};
+
+struct GamelistWriteJob
+{
+	std::string systemName;
+	std::string startPath;
+	std::string xmlPath;
+	int journalGeneration; // Journals up to this generation are obsolete once the changes are written
+
+	std::shared_ptr<GamelistIndex> index;
+	std::vector<GamelistChange> changes;
+};
+
+static std::thread*                                   mGamelistWriterThread = nullptr;
+static std::list<std::shared_ptr<GamelistWriteJob>>   mGamelistWriteQueue;
+static std::mutex                                     mGamelistWriteQueueLock;
+static std::mutex                                     mGamelistWriteLock;
+static std::condition_variable                        mGamelistWriteQueueEvent;
+static bool                                           mExitGamelistWriter = false;
+
+static std::string serializeFileDataNode(FileData* file, SystemData* system)
+{
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("gameList");
+
+	const char* tag = (file->getType() == GAME) ? "game" : "folder";
+	if (!addFileDataNode(root, file, tag, system))
+		return "";
+
+	std::ostringstream stream;
+	root.first_child().print(stream, "\t", pugi::format_default, pugi::encoding_utf8, 1);
+	return stream.str();
+}
+
+static bool copyBytes(std::ifstream& in, std::ofstream& out, size_t count)
 {
-	// We do this by reading the XML again, adding changes and then writing it back,
-	// because there might be information missing in our systemdata which would then miss in the new XML.
-	// We have the complete information for every game though, so we can simply remove a game
-	// we already have in the system from the XML, and then add it back from its GameData information...
+	char buffer[64 * 1024];
+
+	while (count > 0)
+	{
+		size_t chunk = std::min(count, sizeof(buffer));
+		if (!in.read(buffer, chunk))
+			return false;
+
+		out.write(buffer, chunk);
+		count -= chunk;
+	}
+
+	return true;
+}
+
+static void rebuildGamelistIndex(GamelistWriteJob& job)
+{
+	GamelistIndex& index = *job.index;
+	index = GamelistIndex();
+
+	std::string buffer;
+	if (!readGamelistBuffer(job.xmlPath, buffer) || buffer.empty())
+		return;
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = doc.load_buffer(buffer.data(), buffer.size());
+	pugi::xml_node root = doc.child("gameList");
+
+	std::shared_ptr<GamelistIndex> newIndex;
+	if (result && root)
+		newIndex = createGamelistIndex(buffer, root, job.startPath);
+
+	if (newIndex != nullptr)
+	{
+		index = *newIndex;
+		return;
+	}
+
+	if (root && !root.first_child())
+		return; // Empty <gameList/> : it's simply rewritten
+
+	// Don't lose the content of a gamelist we can't understand
+	LOG(LogError) << "Error parsing XML file \"" << job.xmlPath << "\"! It will be rewritten, a copy is kept as \"" << job.xmlPath << ".old\"";
+
+	Utils::FileSystem::removeFile(job.xmlPath + ".old");
+	Utils::FileSystem::copyFile(job.xmlPath, job.xmlPath + ".old");
+}
+
+enum SpliceResult
+{
+	SPLICE_OK,
+	SPLICE_INVALID_INDEX, // The index doesn't match the file content : it has to be rebuilt before trying again
+	SPLICE_ERROR
+};
+
+// Writes a copy of the previous gamelist where the changed entries are replaced, then moves it over the previous one.
+static SpliceResult spliceGamelist(GamelistWriteJob& job)
+{
+	typedef std::pair<GamelistIndex::Range, const GamelistChange*> Replacement;
+
+	GamelistIndex& index = *job.index;
+
+	std::vector<Replacement> replaced;
+	std::vector<const GamelistChange*> appended;
+	std::unordered_set<std::string> replacedPaths;
+
+	for (auto& change : job.changes)
+	{
+		auto it = index.entries.find(change.path);
+		if (it != index.entries.cend())
+		{
+			replaced.push_back(std::make_pair(it->second, &change));
+			replacedPaths.insert(change.path);
+		}
+		else if (!change.xml.empty())
+			appended.push_back(&change);
+	}
+
+	if (replaced.empty() && appended.empty())
+		return SPLICE_OK;
+
+	std::sort(replaced.begin(), replaced.end(), [](const Replacement& a, const Replacement& b) { return a.first.start < b.first.start; });
+
+	std::ifstream in;
+	if (index.fileSize != 0)
+	{
+		in.open(WINSTRINGW(job.xmlPath), std::ios::binary);
+		if (!in)
+			return SPLICE_INVALID_INDEX;
+	}
+
+	std::string tmpPath = job.xmlPath + ".tmp";
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(tmpPath));
+
+	std::ofstream out(WINSTRINGW(tmpPath), std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << tmpPath << "\" (for system " << job.systemName << ")!";
+		return SPLICE_ERROR;
+	}
+
+	GamelistIndex newIndex;
+
+	// Cumulated size difference after the end of each replaced range, used to move the entries that are left untouched
+	std::vector<std::pair<size_t, ptrdiff_t>> shifts;
+	ptrdiff_t shift = 0;
+
+	size_t pos = 0;
+	size_t written = 0;
+	bool valid = true;
+
+	if (index.fileSize == 0)
+	{
+		std::string header = "<?xml version=\"1.0\"?>\n<gameList>\n";
+		out << header;
+		written = header.size();
+	}
+
+	for (auto& item : replaced)
+	{
+		const GamelistIndex::Range& range = item.first;
+		if (range.start < pos || range.end > index.closingTag || !copyBytes(in, out, range.start - pos))
+		{
+			valid = false;
+			break;
+		}
+
+		written += range.start - pos;
+
+		// Make sure we're really replacing the expected element
+		std::string previous(range.end - range.start, '\0');
+		if (previous.empty() || !in.read(&previous[0], previous.size()))
+		{
+			valid = false;
+			break;
+		}
+
+		size_t tagPos = previous.find_first_not_of(" \t\r\n");
+		if (tagPos == std::string::npos || (previous.compare(tagPos, 5, "<game") != 0 && previous.compare(tagPos, 7, "<folder") != 0))
+		{
+			valid = false;
+			break;
+		}
+
+		const std::string& xml = item.second->xml;
+		out << xml;
+
+		if (!xml.empty())
+		{
+			GamelistIndex::Range newRange;
+			newRange.start = written;
+			newRange.end = written + xml.size();
+			newIndex.entries[item.second->path] = newRange;
+		}
+
+		written += xml.size();
+		shift += (ptrdiff_t)xml.size() - (ptrdiff_t)(range.end - range.start);
+		shifts.push_back(std::make_pair(range.end, shift));
+
+		pos = range.end;
+	}
+
+	if (valid && index.fileSize != 0)
+	{
+		valid = copyBytes(in, out, index.closingTag - pos);
+		written += index.closingTag - pos;
+		pos = index.closingTag;
+	}
+
+	if (!valid)
+	{
+		out.close();
+		Utils::FileSystem::removeFile(tmpPath);
+
+		LOG(LogWarning) << "Gamelist \"" << job.xmlPath << "\" was modified since it was indexed";
+		return SPLICE_INVALID_INDEX;
+	}
+
+	for (auto change : appended)
+	{
+		GamelistIndex::Range newRange;
+		newRange.start = written;
+		newRange.end = written + change->xml.size();
+		newIndex.entries[change->path] = newRange;
+
+		out << change->xml;
+		written += change->xml.size();
+	}
+
+	size_t closingTagPos = written;
+
+	if (index.fileSize != 0)
+	{
+		// Copy </gameList> and whatever follows it
+		valid = copyBytes(in, out, index.fileSize - pos);
+		written += index.fileSize - pos;
+	}
+	else
+	{
+		std::string footer = "</gameList>\n";
+		out << footer;
+		written += footer.size();
+	}
+
+	in.close();
+	out.close();
+
+	if (!valid || !out)
+	{
+		Utils::FileSystem::removeFile(tmpPath);
+
+		LOG(LogError) << "Error saving gamelist.xml to \"" << job.xmlPath << "\" (for system " << job.systemName << ")!";
+		return valid ? SPLICE_ERROR : SPLICE_INVALID_INDEX;
+	}
+
+	// rename() replaces the previous file atomically, MoveFile doesn't overwrite existing files
+#if WIN32
+	bool renamed = Utils::FileSystem::renameFile(tmpPath, job.xmlPath, true);
+#else
+	bool renamed = Utils::FileSystem::renameFile(tmpPath, job.xmlPath, false);
+#endif
+
+	if (!renamed)
+	{
+		Utils::FileSystem::removeFile(tmpPath);
+
+		LOG(LogError) << "Error saving gamelist.xml to \"" << job.xmlPath << "\" (for system " << job.systemName << ")!";
+		return SPLICE_ERROR;
+	}
+
+	auto delta = [&shifts](size_t offset)
+	{
+		auto it = std::upper_bound(shifts.cbegin(), shifts.cend(), offset, [](size_t value, const std::pair<size_t, ptrdiff_t>& item) { return value < item.first; });
+		return it == shifts.cbegin() ? (ptrdiff_t)0 : (it - 1)->second;
+	};
+
+	// Untouched entries are moved by the size difference of the replaced ones located before them
+	for (auto& entry : index.entries)
+	{
+		if (replacedPaths.find(entry.first) != replacedPaths.cend())
+			continue;
+
+		GamelistIndex::Range newRange;
+		newRange.start = entry.second.start + delta(entry.second.start);
+		newRange.end = entry.second.end + delta(entry.second.end);
+		newIndex.entries[entry.first] = newRange;
+	}
+
+	newIndex.closingTag = closingTagPos;
+	newIndex.fileSize = written;
+
+	index = newIndex;
+
+	LOG(LogInfo) << "Added/Updated " << job.changes.size() << " entities in '" << job.xmlPath << "'";
+	return SPLICE_OK;
+}
+
+static void commitGamelistChanges(GamelistWriteJob& job)
+{
+	StopWatch stopWatch("updateGamelist - " + job.systemName + " :", LogDebug);
+
+	GamelistIndex& index = *job.index;
+
+	if (!Utils::FileSystem::exists(job.xmlPath))
+		index = GamelistIndex();
+	else if (index.fileSize == 0 || Utils::FileSystem::getFileSize(job.xmlPath) != index.fileSize)
+		rebuildGamelistIndex(job);
+
+	SpliceResult result = spliceGamelist(job);
+	if (result == SPLICE_INVALID_INDEX)
+	{
+		rebuildGamelistIndex(job);
+		result = spliceGamelist(job);
+	}
+
+	if (result != SPLICE_OK)
+	{
+		// Journals are kept : changes will be replayed at next start
+		index = GamelistIndex();
+		return;
+	}
+
+	GamelistJournal::compact(job.systemName, job.journalGeneration);
+}
+
+static void processGamelistWrites()
+{
+	std::unique_lock<std::mutex> writeLock(mGamelistWriteLock);
+
+	while (true)
+	{
+		std::shared_ptr<GamelistWriteJob> job;
+
+		{
+			std::unique_lock<std::mutex> lock(mGamelistWriteQueueLock);
+			if (mGamelistWriteQueue.empty())
+				break;
+
+			job = mGamelistWriteQueue.front();
+			mGamelistWriteQueue.pop_front();
+		}
+
+		commitGamelistChanges(*job);
+	}
+}
+
+static void gamelistWriterThread()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mGamelistWriteQueueLock);
+			mGamelistWriteQueueEvent.wait(lock, []() { return mExitGamelistWriter || !mGamelistWriteQueue.empty(); });
+
+			if (mExitGamelistWriter)
+				break;
+		}
+
+		processGamelistWrites();
+	}
+}
+
+void updateGamelist(SystemData* system, bool async)
+{
+	// Only the entries that changed are serialized here. They are then spliced into a copy of the previous gamelist.xml
+	// using the node offsets indexed when it was parsed, so the file never needs to be parsed again.
+	// Everything we don't know about in the previous file is copied as is.
 
 	if (system == nullptr || Settings::IgnoreGamelist())
 		return;
@@ -378,84 +855,90 @@ void updateGamelist(SystemData* system)
 
 	if (dirtyFiles.size() == 0)
 	{
-		clearTemporaryGamelistRecovery(system);
+		if (!async)
+		{
+			// Pending writes may still rely on the journal
+			processGamelistWrites();
+			clearTemporaryGamelistRecovery(system);
+		}
+
 		return;
 	}
 
-	int numUpdated = 0;
+	auto index = system->getGamelistIndex();
+	if (index == nullptr)
+	{
+		index = std::make_shared<GamelistIndex>();
+		system->setGamelistIndex(index);
+	}
 
-	pugi::xml_document doc;
-	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
+	auto job = std::make_shared<GamelistWriteJob>();
+	job->systemName = system->getName();
+	job->startPath = system->getStartPath();
+	job->xmlPath = system->getGamelistPath(true);
+	job->index = index;
 
-	if(Utils::FileSystem::exists(xmlReadPath))
 	{
-		//parse an existing file first
-		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
-		if(!result)
-			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
+		// Changes are collected & queued under the same lock, so they're always written in the order they were made
+		std::unique_lock<std::mutex> lock(mGamelistWriteQueueLock);
 
-		root = doc.child("gameList");
-		if(!root)
+		for (auto file : dirtyFiles)
 		{
-			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-			root = doc.append_child("gameList");
+			GamelistChange change;
+			change.path = file->getPath();
+			change.xml = serializeFileDataNode(file, system);
+			job->changes.push_back(change);
+
+			file->getMetadata().resetChangedFlag();
 		}
-	}
-	else //set up an empty gamelist to append to		
-		root = doc.append_child("gameList");
 
-	std::map<std::string, pugi::xml_node> xmlMap;
+		job->journalGeneration = GamelistJournal::rotate(system);
 
-	for (pugi::xml_node fileNode : root.children())
-	{
-		pugi::xml_node path = fileNode.child("path");
-		if (path)
+		mGamelistWriteQueue.push_back(job);
+
+		if (async)
 		{
-			std::string nodePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
-			xmlMap[nodePath] = fileNode;
+			if (mGamelistWriterThread == nullptr)
+			{
+				mExitGamelistWriter = false;
+				mGamelistWriterThread = new std::thread(&gamelistWriterThread);
+			}
+
+			mGamelistWriteQueueEvent.notify_one();
 		}
 	}
-	
-	// iterate through all files, checking if they're already in the XML
-	for(auto file : dirtyFiles)
-	{
-		bool removed = false;
 
-		// check if the file already exists in the XML
-		// if it does, remove it before adding
-		auto xmf = xmlMap.find(Utils::FileSystem::getCanonicalPath(file->getPath()));
-		if (xmf != xmlMap.cend())
-		{
-			removed = true;
-			root.remove_child(xmf->second);
-		}
-		
-		const char* tag = (file->getType() == GAME) ? "game" : "folder";
+	if (!async)
+		processGamelistWrites();
+}
 
-		// it was either removed or never existed to begin with; either way, we can add it now
-		if (addFileDataNode(root, file, tag, system))
-			++numUpdated; // Only if really added
-		else if (removed)
-			++numUpdated; // Only if really removed
-	}
+void updateDirtyGamelists(bool async)
+{
+	if (Settings::IgnoreGamelist() || !Settings::SaveGamelistsOnExit())
+		return;
 
-	// Now write the file
-	if (numUpdated > 0) 
+	for (auto system : SystemData::sSystemVector)
+		if (!system->isCollection())
+			updateGamelist(system, async);
+}
+
+void waitForGamelistWrites(bool stopWriter)
+{
+	if (stopWriter && mGamelistWriterThread != nullptr)
 	{
-		//make sure the folders leading up to this path exist (or the write will fail)
-		std::string xmlWritePath(system->getGamelistPath(true));
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+		{
+			std::unique_lock<std::mutex> lock(mGamelistWriteQueueLock);
+			mExitGamelistWriter = true;
+		}
 
-		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+		mGamelistWriteQueueEvent.notify_one();
+		mGamelistWriterThread->join();
 
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-		else
-			clearTemporaryGamelistRecovery(system);
+		delete mGamelistWriterThread;
+		mGamelistWriterThread = nullptr;
 	}
-	else
-		clearTemporaryGamelistRecovery(system);
+
+	processGamelistWrites();
 }
 
 void resetGamelistUsageData(SystemData* system)
@@ -509,6 +992,8 @@ void cleanupGamelist(SystemData* system)
 	if (!Utils::FileSystem::exists(xmlReadPath))
 		return;
 
+	waitForGamelistWrites();
+
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
 	if (!result)
@@ -707,6 +1192,10 @@ void cleanupGamelist(SystemData* system)
 			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
 		else
 			clearTemporaryGamelistRecovery(system);
+
+		// The file was entirely rewritten
+		if (system->getGamelistIndex() != nullptr)
+			*system->getGamelistIndex() = GamelistIndex();
 	}
 	else
 		clearTemporaryGamelistRecovery(system);
@@ -10,21 +10,45 @@
 class SystemData;
 class FileData;
 
+namespace pugi { class xml_node; }
+
+// Byte ranges of the <game>/<folder> entries of a gamelist.xml, as it was last parsed or written.
+// updateGamelist uses it to splice dirty entries into a copy of the previous file instead of reloading the whole document.
+struct GamelistIndex
+{
+	struct Range
+	{
+		size_t start; // Beginning of the line holding the opening tag
+		size_t end;   // Beginning of the next entry, or of the </gameList> line
+	};
+
+	GamelistIndex() : fileSize(0), closingTag(0) { }
+
+	size_t fileSize; // 0 when the index is unknown and must be rebuilt from the file
+	size_t closingTag;
+	std::unordered_map<std::string, Range> entries; // Keyed by resolved path, the same way FileData::getPath() is
+};
+
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
 
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
-void updateGamelist(SystemData* system);
+// When async is true, the file is written by a background thread.
+void updateGamelist(SystemData* system, bool async = false);
+void updateDirtyGamelists(bool async = true);
+void waitForGamelistWrites(bool stopWriter = false);
+
 void cleanupGamelist(SystemData* system);
 void resetGamelistUsageData(SystemData* system);
 
 bool saveToGamelistRecovery(FileData* file);
-bool removeFromGamelistRecovery(FileData* file);
 
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths = false);
 
 bool hasDirtyFile(SystemData* system);
 
+// Applies the <game>/<folder> nodes of an already parsed <gameList> to the system, and returns the updated files.
+std::vector<FileData*> loadGamelistNodes(pugi::xml_node& root, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize = SIZE_MAX, bool fromFile = true);
 std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize = SIZE_MAX, bool fromFile = true);
 
 #endif // ES_APP_GAME_LIST_H
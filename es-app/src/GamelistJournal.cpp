@@ -0,0 +1,397 @@
+#include "GamelistJournal.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/ZipFile.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "MetaData.h"
+#include "Genres.h"
+#include "Paths.h"
+#include "Log.h"
+#include <fstream>
+#include <chrono>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Pending records are written at most every FLUSH_DELAY ms, or as soon as there's more than FLUSH_SIZE bytes waiting
+#define FLUSH_DELAY 250
+#define FLUSH_SIZE  (256 * 1024)
+
+#define JOURNAL_HEADER     "ESJ1"
+#define JOURNAL_HEADER_LEN 4
+
+std::unordered_map<std::string, GamelistJournal::Journal> GamelistJournal::mJournals;
+size_t                  GamelistJournal::mPendingSize = 0;
+std::mutex              GamelistJournal::mLock;
+std::mutex              GamelistJournal::mIOLock;
+std::condition_variable GamelistJournal::mEvent;
+std::thread*            GamelistJournal::mThread = nullptr;
+bool                    GamelistJournal::mExit = false;
+
+// Record layout ( little endian ) :
+//   u32 payload size | payload | u32 crc32 of payload
+// Payload :
+//   u16 path length | path relative to the system start path | u8 field count | { u8 metadata id | u32 value length | value } * count
+
+static void writeUInt(std::string& buffer, unsigned int value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		buffer.push_back((char)((value >> (i * 8)) & 0xFF));
+}
+
+static bool readUInt(const std::string& buffer, size_t& pos, size_t end, unsigned int& value, int bytes)
+{
+	if (pos + bytes > end)
+		return false;
+
+	value = 0;
+	for (int i = 0; i < bytes; i++)
+		value |= ((unsigned int)(unsigned char)buffer[pos + i]) << (i * 8);
+
+	pos += bytes;
+	return true;
+}
+
+std::string GamelistJournal::getJournalFolder(const std::string& systemName)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/recovery/" + systemName);
+}
+
+std::map<int, std::string> GamelistJournal::getJournalFiles(const std::string& folder)
+{
+	std::map<int, std::string> ret;
+
+	for (auto file : Utils::FileSystem::getDirContent(folder, false))
+	{
+		if (Utils::String::toLower(Utils::FileSystem::getExtension(file)) != ".journal")
+			continue;
+
+		std::string stem = Utils::FileSystem::getStem(file);
+		if (stem.empty() || stem.find_first_not_of("0123456789") != std::string::npos)
+			continue;
+
+		ret[Utils::String::toInteger(stem)] = file;
+	}
+
+	return ret;
+}
+
+GamelistJournal::Journal& GamelistJournal::getJournal(SystemData* system)
+{
+	Journal& journal = mJournals[system->getName()];
+	if (journal.generation < 0)
+	{
+		// Never append to a journal left by a previous session : it may end with a torn record
+		journal.folder = getJournalFolder(system->getName());
+		journal.generation = 0;
+
+		auto files = getJournalFiles(journal.folder);
+		if (files.size())
+			journal.generation = files.rbegin()->first + 1;
+	}
+
+	return journal;
+}
+
+void GamelistJournal::append(FileData* file)
+{
+	if (file == nullptr)
+		return;
+
+	FileData* source = file->getSourceFileData();
+
+	SystemData* system = source->getSystem();
+	if (system == nullptr || !system->isGameSystem() || system->isCollection())
+		return;
+
+	MetaDataList& mdl = source->getMetadata();
+
+	uint64_t mask = mdl.getJournalMask();
+	if (mask == 0)
+		return;
+
+	std::string path = Utils::FileSystem::createRelativePath(source->getPath(), system->getStartPath(), false);
+
+	std::string payload;
+	writeUInt(payload, (unsigned int)path.size(), 2);
+	payload.append(path);
+
+	size_t countPos = payload.size();
+	payload.push_back(0);
+
+	int count = 0;
+	for (int id = 0; id < 64; id++)
+	{
+		if ((mask & (1ULL << id)) == 0)
+			continue;
+
+		std::string value = mdl.get((MetaDataId)id);
+
+		payload.push_back((char)id);
+		writeUInt(payload, (unsigned int)value.size(), 4);
+		payload.append(value);
+		count++;
+	}
+
+	payload[countPos] = (char)count;
+	mdl.resetJournalMask();
+
+	std::string record;
+	record.reserve(payload.size() + 8);
+	writeUInt(record, (unsigned int)payload.size(), 4);
+	record.append(payload);
+	writeUInt(record, Utils::Zip::ZipFile::computeCRC(0, payload.data(), payload.size()), 4);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Journal& journal = getJournal(system);
+	journal.pending[journal.generation].append(record);
+	mPendingSize += record.size();
+
+	if (mThread == nullptr)
+	{
+		mExit = false;
+		mThread = new std::thread(&GamelistJournal::run);
+	}
+
+	mEvent.notify_one();
+}
+
+int GamelistJournal::rotate(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Journal& journal = getJournal(system);
+	return journal.generation++;
+}
+
+void GamelistJournal::compact(const std::string& systemName, int generation)
+{
+	std::unique_lock<std::mutex> ioLock(mIOLock);
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		auto it = mJournals.find(systemName);
+		if (it != mJournals.cend())
+		{
+			auto& pending = it->second.pending;
+			while (pending.size() && pending.cbegin()->first <= generation)
+			{
+				mPendingSize -= pending.cbegin()->second.size();
+				pending.erase(pending.cbegin());
+			}
+		}
+	}
+
+	for (auto file : getJournalFiles(getJournalFolder(systemName)))
+		if (file.first <= generation)
+			Utils::FileSystem::removeFile(file.second);
+}
+
+void GamelistJournal::replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	std::string folder = getJournalFolder(system->getName());
+
+	auto files = getJournalFiles(folder);
+	if (files.size() == 0)
+		return;
+
+	StopWatch stopWatch("GamelistJournal::replay - " + system->getName() + " :", LogDebug);
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		getJournal(system);
+	}
+
+	std::string relativeTo = system->getStartPath();
+	int records = 0;
+
+	for (auto journalFile : files)
+	{
+		std::ifstream stream(WINSTRINGW(journalFile.second), std::ios::in | std::ios::binary);
+		if (!stream.is_open())
+			continue;
+
+		std::string buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		stream.close();
+
+		if (buffer.size() < JOURNAL_HEADER_LEN || buffer.compare(0, JOURNAL_HEADER_LEN, JOURNAL_HEADER) != 0)
+		{
+			LOG(LogWarning) << "GamelistJournal : invalid journal \"" << journalFile.second << "\"";
+			continue;
+		}
+
+		size_t pos = JOURNAL_HEADER_LEN;
+		while (pos < buffer.size())
+		{
+			unsigned int size, crc;
+			if (!readUInt(buffer, pos, buffer.size(), size, 4) || pos + size + 4 > buffer.size())
+			{
+				LOG(LogWarning) << "GamelistJournal : torn record in \"" << journalFile.second << "\"";
+				break;
+			}
+
+			size_t end = pos + size;
+			size_t crcPos = end;
+			readUInt(buffer, crcPos, buffer.size(), crc, 4);
+
+			if (crc != Utils::Zip::ZipFile::computeCRC(0, buffer.data() + pos, size))
+			{
+				LOG(LogWarning) << "GamelistJournal : bad checksum in \"" << journalFile.second << "\"";
+				break;
+			}
+
+			unsigned int pathLength, count;
+			if (!readUInt(buffer, pos, end, pathLength, 2) || pos + pathLength > end)
+				break;
+
+			std::string path = Utils::FileSystem::resolveRelativePath(buffer.substr(pos, pathLength), relativeTo, false);
+			pos += pathLength;
+
+			if (!readUInt(buffer, pos, end, count, 1))
+				break;
+
+			FileData* file = nullptr;
+
+			auto it = fileMap.find(path);
+			if (it != fileMap.cend())
+				file = it->second;
+
+			for (unsigned int i = 0; i < count; i++)
+			{
+				unsigned int id, length;
+				if (!readUInt(buffer, pos, end, id, 1) || !readUInt(buffer, pos, end, length, 4) || pos + length > end)
+					break;
+
+				if (file != nullptr && id < (unsigned int)MetaDataList::getMDD().size())
+					file->getMetadata().set((MetaDataId)id, buffer.substr(pos, length));
+
+				pos += length;
+			}
+
+			if (file != nullptr)
+			{
+				MetaDataList& mdl = file->getMetadata();
+				Genres::convertGenreToGenreIds(&mdl);
+
+				// Already in the journal : keep it dirty so it's written to gamelist.xml, and the journal compacted
+				mdl.resetJournalMask();
+				mdl.setDirty();
+			}
+
+			pos = end + 4;
+			records++;
+		}
+	}
+
+	LOG(LogInfo) << "GamelistJournal : replayed " << records << " changes for " << system->getName();
+}
+
+void GamelistJournal::writePending()
+{
+	// IO lock first : compact must never run between the moment records are taken, and the moment they're written
+	std::unique_lock<std::mutex> ioLock(mIOLock);
+
+	std::vector<std::pair<std::string, std::string>> writes;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		for (auto& journal : mJournals)
+		{
+			for (auto& pending : journal.second.pending)
+				writes.push_back(std::make_pair(journal.second.folder + "/" + std::to_string(pending.first) + ".journal", std::move(pending.second)));
+
+			journal.second.pending.clear();
+		}
+
+		mPendingSize = 0;
+	}
+
+	for (auto& write : writes)
+	{
+		std::string folder = Utils::FileSystem::getParent(write.first);
+		if (!Utils::FileSystem::exists(folder))
+			Utils::FileSystem::createDirectory(folder);
+
+		bool newFile = Utils::FileSystem::getFileSize(write.first) == 0;
+
+#if defined(_WIN32)
+		FILE* file = _wfopen(Utils::String::convertToWideString(write.first).c_str(), newFile ? L"wb" : L"ab");
+#else
+		FILE* file = fopen(write.first.c_str(), newFile ? "wb" : "ab");
+#endif
+		if (file == nullptr)
+		{
+			LOG(LogError) << "GamelistJournal : unable to open \"" << write.first << "\"";
+			continue;
+		}
+
+		if (newFile)
+			fwrite(JOURNAL_HEADER, 1, JOURNAL_HEADER_LEN, file);
+
+		fwrite(write.second.data(), 1, write.second.size(), file);
+		fflush(file);
+
+#if defined(_WIN32)
+		_commit(_fileno(file));
+#else
+		fsync(fileno(file));
+#endif
+		fclose(file);
+	}
+}
+
+void GamelistJournal::run()
+{
+	while (true)
+	{
+		bool exit;
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mEvent.wait(lock, []() { return mExit || mPendingSize > 0; });
+
+			// Group commit : wait a bit, so a burst of changes costs a single sync
+			if (!mExit && mPendingSize < FLUSH_SIZE)
+				mEvent.wait_for(lock, std::chrono::milliseconds(FLUSH_DELAY), []() { return mExit || mPendingSize >= FLUSH_SIZE; });
+
+			exit = mExit;
+		}
+
+		writePending();
+
+		if (exit)
+			break;
+	}
+}
+
+void GamelistJournal::flush()
+{
+	writePending();
+}
+
+void GamelistJournal::stop()
+{
+	if (mThread != nullptr)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mExit = true;
+		}
+
+		mEvent.notify_one();
+		mThread->join();
+
+		delete mThread;
+		mThread = nullptr;
+	}
+
+	writePending();
+}
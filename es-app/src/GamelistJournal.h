@@ -0,0 +1,65 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_JOURNAL_H
+#define ES_APP_GAMELIST_JOURNAL_H
+
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <thread>
+#include <condition_variable>
+#include <mutex>
+
+class FileData;
+class SystemData;
+
+// Per-system append-only journal of metadata changes, replayed at load and compacted once they are written to gamelist.xml.
+// Records are buffered in memory, and written + fsync'ed in batches by a background thread.
+//
+// Files are named recovery/<system>/<generation>.journal. Each time updateGamelist collects changes, the journal is rotated :
+// the previous generations can be removed as soon as the gamelist containing them is written.
+class GamelistJournal
+{
+public:
+	// Appends the metadata that changed since the last call for this file
+	static void append(FileData* file);
+
+	// Applies the journals left by a previous session. Replayed games are marked as changed, so they'll be compacted into gamelist.xml
+	static void replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
+
+	// Closes the current generation, and returns it
+	static int  rotate(SystemData* system);
+
+	// Removes all journals up to this generation, once they're safely written to gamelist.xml
+	static void compact(const std::string& systemName, int generation);
+
+	// Writes & syncs all pending records
+	static void flush();
+	static void stop();
+
+private:
+	struct Journal
+	{
+		Journal() : generation(-1) { }
+
+		std::string folder;
+		int generation;
+		std::map<int, std::string> pending; // Records waiting to be written, by generation
+	};
+
+	static std::string getJournalFolder(const std::string& systemName);
+	static std::map<int, std::string> getJournalFiles(const std::string& folder);
+	static Journal&    getJournal(SystemData* system);
+	static void        writePending();
+	static void        run();
+
+	static std::unordered_map<std::string, Journal> mJournals;
+	static size_t                   mPendingSize;
+
+	static std::mutex               mLock;   // Protects mJournals
+	static std::mutex               mIOLock; // Held while writing or deleting journal files
+	static std::condition_variable  mEvent;
+	static std::thread*             mThread;
+	static bool                     mExit;
+};
+
+#endif // ES_APP_GAMELIST_JOURNAL_H
@@ -11,6 +11,7 @@
 #include "ImageIO.h"
 
 std::vector<MetaDataDecl> MetaDataList::mMetaDataDecls;
+std::atomic<unsigned int> MetaDataList::mGlobalGeneration(0);
 
 static std::map<MetaDataId, int> mMetaDataIndexes;
 static std::string* mDefaultGameMap = nullptr;
@@ -140,7 +141,7 @@ MetaDataId MetaDataList::getId(const std::string& key) const
 	return mGameIdMap[key];
 }
 
-MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRelativeTo(nullptr)
+MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mJournalMask(0), mGeneration(0), mRelativeTo(nullptr)
 {
 
 }
@@ -203,7 +204,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 
 		if (mdd.id == MetaDataId::Name)
 		{
-			mName = value;
+			set(mdd.id, value);
 			continue;
 		}
 
@@ -256,10 +257,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		// if (type == GAME_METADATA && mdd.id == MetaDataId::Players && Utils::String::startsWith(value, "1-"))
 		// 	value = Utils::String::replace(value, "1-", "");
 
-		if (mdd.id == MetaDataId::Name)
-			mName = value;
-		else
-			set(mdd.id, value);
+		set(mdd.id, value);
 	}
 }
 
@@ -358,6 +356,8 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 
 		mName = value;
 		mWasChanged = true;
+		mJournalMask |= 1ULL << (int)id;
+		mGeneration = ++mGlobalGeneration;
 		return;
 	}
 
@@ -378,6 +378,8 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 		mMap[id] = Utils::String::trim(value);
 
 	mWasChanged = true;
+	mJournalMask |= 1ULL << (int)id;
+	mGeneration = ++mGlobalGeneration;
 }
 
 const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) const
@@ -436,6 +438,7 @@ bool MetaDataList::wasChanged() const
 void MetaDataList::resetChangedFlag()
 {
 	mWasChanged = false;
+	mJournalMask = 0;
 }
 
 void MetaDataList::importScrappedMetadata(const MetaDataList& source)
@@ -6,6 +6,8 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <cstdint>
+#include <atomic>
 
 #include "utils/TimeUtil.h"
 
@@ -163,6 +165,14 @@ public:
 		mWasChanged = true; 
 	}
 
+	// Ids set since the last time the file was written to the gamelist journal (see GamelistJournal)
+	inline uint64_t getJournalMask() const { return mJournalMask; }
+	inline void resetJournalMask() { mJournalMask = 0; }
+
+	// Value of the global generation at the last change : used to find what changed since a point in time
+	inline unsigned int getGeneration() const { return mGeneration; }
+	static unsigned int getGlobalGeneration() { return mGlobalGeneration; }
+
 	inline MetaDataListType getType() const { return mType; }
 	static const std::vector<MetaDataDecl>& getMDD() { return mMetaDataDecls; }
 	inline const std::string& getName() const { return mName; }
@@ -183,8 +193,12 @@ private:
 	MetaDataListType mType;
 	std::map<MetaDataId, std::string> mMap;
 	bool mWasChanged;
+	uint64_t mJournalMask;
+	unsigned int mGeneration;
 	SystemData*		mRelativeTo;
 
+	static std::atomic<unsigned int> mGlobalGeneration;
+
 	static std::vector<MetaDataDecl> mMetaDataDecls;
 
 	std::vector<std::tuple<std::string, std::string, bool>> mUnKnownElements;
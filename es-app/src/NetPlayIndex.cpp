@@ -0,0 +1,215 @@
+#include "NetPlayIndex.h"
+
+#include "FileData.h"
+#include "SystemData.h"
+#include "utils/StringUtil.h"
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include <vector>
+
+std::unordered_map<FileData*, NetPlayIndex::IndexedGame>	NetPlayIndex::mGames;
+std::unordered_multimap<std::string, FileData*>			NetPlayIndex::mByCrc;
+std::unordered_multimap<std::string, FileData*>			NetPlayIndex::mByName;
+std::unordered_multimap<std::string, FileData*>			NetPlayIndex::mByNameNoSpace;
+
+bool			NetPlayIndex::mBuilt = false;
+unsigned int	NetPlayIndex::mGeneration = 0;
+unsigned int	NetPlayIndex::mTreeGeneration = 0;
+unsigned int	NetPlayIndex::mNextOrder = 0;
+std::mutex NetPlayIndex::mLock;
+
+std::string NetPlayIndex::normalizeName(const std::string& name)
+{
+	auto ret = Utils::String::toLower(name);
+	ret = Utils::String::replace(ret, "_", " ");
+	ret = Utils::String::replace(ret, ".", "");
+	ret = Utils::String::replace(ret, "'", "");
+	return Utils::String::removeParenthesis(ret);
+}
+
+static void eraseValue(std::unordered_multimap<std::string, FileData*>& map, const std::string& key, FileData* game)
+{
+	auto range = map.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == game)
+		{
+			map.erase(it);
+			return;
+		}
+	}
+}
+
+void NetPlayIndex::add(FileData* game, SystemData* system)
+{
+	IndexedGame entry;
+	entry.system = system;
+	entry.order = mNextOrder++;
+	entry.crc = Utils::String::toUpper(game->getMetadata(MetaDataId::Crc32));
+	entry.name = normalizeName(game->getName());
+	entry.stem = normalizeName(Utils::FileSystem::getStem(game->getPath()));
+	entry.nameNoSpace = Utils::String::replace(entry.name, " ", "");
+
+	if (!entry.crc.empty())
+		mByCrc.emplace(entry.crc, game);
+
+	mByName.emplace(entry.name, game);
+	if (entry.stem != entry.name)
+		mByName.emplace(entry.stem, game);
+
+	mByNameNoSpace.emplace(entry.nameNoSpace, game);
+
+	mGames[game] = entry;
+}
+
+void NetPlayIndex::unlink(FileData* game, const IndexedGame& entry)
+{
+	if (!entry.crc.empty())
+		eraseValue(mByCrc, entry.crc, game);
+
+	eraseValue(mByName, entry.name, game);
+	if (entry.stem != entry.name)
+		eraseValue(mByName, entry.stem, game);
+
+	eraseValue(mByNameNoSpace, entry.nameNoSpace, game);
+}
+
+void NetPlayIndex::update()
+{
+	unsigned int generation = MetaDataList::getGlobalGeneration();
+	unsigned int treeGeneration = FolderData::getTreeGeneration();
+
+	// Games were added since the index was built : their place in the search order is only known by walking the systems again
+	if (mBuilt && treeGeneration != mTreeGeneration)
+	{
+		mGames.clear();
+		mByCrc.clear();
+		mByName.clear();
+		mByNameNoSpace.clear();
+
+		mBuilt = false;
+		mNextOrder = 0;
+	}
+
+	if (!mBuilt)
+	{
+		StopWatch watch("NetPlayIndex::build", LogDebug);
+
+		for (auto sys : SystemData::sSystemVector)
+		{
+			if (!sys->isNetplaySupported())
+				continue;
+
+			for (auto file : sys->getRootFolder()->getFilesRecursive(GAME, false, sys))
+				add(file, sys);
+		}
+
+		mBuilt = true;
+		mGeneration = generation;
+		mTreeGeneration = treeGeneration;
+		return;
+	}
+
+	if (generation == mGeneration)
+		return;
+
+	std::vector<std::pair<FileData*, IndexedGame>> changed;
+
+	for (auto& it : mGames)
+		if (it.first->getMetadata().getGeneration() > mGeneration)
+			changed.push_back(it);
+
+	for (auto& it : changed)
+	{
+		unlink(it.first, it.second);
+
+		// Keep the place of the game in the search order
+		unsigned int order = mNextOrder;
+		mNextOrder = it.second.order;
+		add(it.first, it.second.system);
+		mNextOrder = order;
+	}
+
+	mGeneration = generation;
+}
+
+FileData* NetPlayIndex::findFirst(std::unordered_multimap<std::string, FileData*>& map, const std::string& key, const std::string& lowCore, FileData* best)
+{
+	auto range = map.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		auto& entry = mGames[it->second];
+		if (best != nullptr && mGames[best].order < entry.order)
+			continue;
+
+		if (!lowCore.empty()) // CRC matches are not restricted to a core
+		{
+			bool coreExists = false;
+
+			for (auto& emul : entry.system->getEmulators())
+				for (auto& core : emul.cores)
+					if (Utils::String::toLower(core.name) == lowCore)
+						coreExists = true;
+
+			if (!coreExists)
+				continue;
+		}
+
+		best = it->second;
+	}
+
+	return best;
+}
+
+FileData* NetPlayIndex::findByCrc(const std::string& crc)
+{
+	if (crc.empty())
+		return nullptr;
+
+	std::unique_lock<std::mutex> lock(mLock);
+	update();
+
+	return findFirst(mByCrc, Utils::String::toUpper(crc), "", nullptr);
+}
+
+FileData* NetPlayIndex::findByName(const std::string& name, const std::string& coreName)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	update();
+
+	std::string lowCore = Utils::String::toLower(coreName);
+	if (lowCore.empty())
+		return nullptr;
+
+	std::string normalizedName = normalizeName(name);
+
+	FileData* best = findFirst(mByName, normalizedName, lowCore, nullptr);
+	return findFirst(mByNameNoSpace, Utils::String::replace(normalizedName, " ", ""), lowCore, best);
+}
+
+void NetPlayIndex::remove(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	if (!mBuilt)
+		return;
+
+	auto it = mGames.find(game);
+	if (it == mGames.cend())
+		return;
+
+	unlink(game, it->second);
+	mGames.erase(it);
+}
+
+void NetPlayIndex::reset()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mGames.clear();
+	mByCrc.clear();
+	mByName.clear();
+	mByNameNoSpace.clear();
+
+	mBuilt = false;
+	mNextOrder = 0;
+}
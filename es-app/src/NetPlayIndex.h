@@ -0,0 +1,57 @@
+#pragma once
+#ifndef ES_APP_NETPLAY_INDEX_H
+#define ES_APP_NETPLAY_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+class FileData;
+class SystemData;
+
+// Games of the netplay capable systems, indexed by CRC32 and by normalized name, to match lobby rooms with local games.
+// The index is built on first use and kept until the systems are reloaded. Games whose metadata changed since the last
+// lookup (MetaDataList generations, as set by the editor, the scrapers or ThreadedHasher) are re-indexed before the next one,
+// deleted games remove themselves, and the index is rebuilt when games were added to the tree (FolderData::getTreeGeneration).
+class NetPlayIndex
+{
+public:
+	static FileData* findByCrc(const std::string& crc);
+
+	// coreName : only the systems having this libretro core are searched
+	static FileData* findByName(const std::string& name, const std::string& coreName);
+
+	static void remove(FileData* game);
+	static void reset();
+
+	static std::string normalizeName(const std::string& name);
+
+private:
+	struct IndexedGame
+	{
+		SystemData* system;
+		unsigned int order; // Systems order, then gamelist order : the first match wins, like a sequential search would
+		std::string crc;
+		std::string name;
+		std::string stem;
+		std::string nameNoSpace;
+	};
+
+	static void update();
+	static void add(FileData* game, SystemData* system);
+	static void unlink(FileData* game, const IndexedGame& entry);
+	static FileData* findFirst(std::unordered_multimap<std::string, FileData*>& map, const std::string& key, const std::string& lowCore, FileData* best);
+
+	static std::unordered_map<FileData*, IndexedGame>			mGames;
+	static std::unordered_multimap<std::string, FileData*>	mByCrc;
+	static std::unordered_multimap<std::string, FileData*>	mByName;
+	static std::unordered_multimap<std::string, FileData*>	mByNameNoSpace;
+
+	static bool			mBuilt;
+	static unsigned int mGeneration;
+	static unsigned int mTreeGeneration;
+	static unsigned int mNextOrder;
+	static std::mutex	mLock;
+};
+
+#endif // ES_APP_NETPLAY_INDEX_H
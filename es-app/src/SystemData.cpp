@@ -5,8 +5,11 @@
 #include "utils/ThreadPool.h"
 #include "CollectionSystemManager.h"
 #include "FileFilterIndex.h"
+#include "NetPlayIndex.h"
+#include "services/GameIdIndex.h"
 #include "FileSorts.h"
 #include "Gamelist.h"
+#include "GamelistJournal.h"
 #include "Log.h"
 #include "utils/Platform.h"
 #include "Settings.h"
@@ -402,6 +405,8 @@ void SystemData::createGroupedSystems()
 		map[sys->getSystemEnvData()->mGroup].push_back(sys);		
 	}
 
+	std::vector<SystemData*> newSystems;
+
 	for (auto item : map)
 	{	
 		// Don't group if system count is only 1 		
@@ -537,18 +542,21 @@ void SystemData::createGroupedSystems()
 		}
 
 		if (root->getChildren().size() > 0 && !existingSystem)
-		{
-			system->loadTheme();
-
-			auto defaultView = Settings::getInstance()->getString(system->getName() + ".defaultView");
-			auto gridSizeOverride = Vector2f::parseString(Settings::getInstance()->getString(system->getName() + ".gridSize"));
-			system->setSystemViewMode(defaultView, gridSizeOverride, false);
-
-			sSystemVector.push_back(system);
-		}
+			newSystems.push_back(system);
 		
 		root->getMetadata().resetChangedFlag();
 	}
+
+	loadThemes(newSystems);
+
+	for (auto system : newSystems)
+	{
+		auto defaultView = Settings::getInstance()->getString(system->getName() + ".defaultView");
+		auto gridSizeOverride = Vector2f::parseString(Settings::getInstance()->getString(system->getName() + ".gridSize"));
+		system->setSystemViewMode(defaultView, gridSizeOverride, false);
+
+		sSystemVector.push_back(system);
+	}
 }
 
 bool SystemData::loadFeatures()
@@ -835,6 +843,7 @@ bool SystemData::loadConfig(Window* window)
 	}
 
 	Utils::FileSystem::FileSystemCacheActivator fsc;
+	ThemeData::DocumentCacheActivator tdc;
 
 	CustomFeatures::loadEsFeaturesFile();
 
@@ -1209,6 +1218,9 @@ bool SystemData::hasDirtySystems()
 
 void SystemData::deleteSystems()
 {
+	NetPlayIndex::reset();
+	GameIdIndex::reset();
+
 	bool saveOnExit = !Settings::IgnoreGamelist() && Settings::SaveGamelistsOnExit();
 
 	for (unsigned int i = 0; i < sSystemVector.size(); i++)
@@ -1222,6 +1234,10 @@ void SystemData::deleteSystems()
 		delete pData;
 	}
 
+	// Background writes may still be pending if saving on exit is disabled
+	waitForGamelistWrites(true);
+	GamelistJournal::stop();
+
 	sSystemVector.clear();
 	IsManufacturerSupported = false;
 }
@@ -1584,6 +1600,30 @@ void SystemData::loadTheme()
 	}
 }
 
+void SystemData::loadThemes(const std::vector<SystemData*>& systems)
+{
+	if (systems.size() == 0)
+		return;
+
+	// Files included by several themes are parsed once
+	ThemeData::DocumentCacheActivator tdc;
+
+	if (systems.size() == 1 || std::thread::hardware_concurrency() <= 1 || !Settings::ThreadedLoading())
+	{
+		for (auto system : systems)
+			system->loadTheme();
+
+		return;
+	}
+
+	ThreadPool pool;
+
+	for (auto system : systems)
+		pool.queueWorkItem([system] { system->loadTheme(); });
+
+	pool.wait();
+}
+
 void SystemData::setSortId(const unsigned int sortId)
 {
 	mSortId = sortId;
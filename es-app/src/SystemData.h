@@ -24,6 +24,7 @@ class FolderData;
 class ThemeData;
 class Window;
 class SaveStateRepository;
+struct GamelistIndex;
 
 struct GameCountInfo
 {
@@ -138,6 +139,8 @@ public:
 
 	// Load or re-load theme.
 	void loadTheme();
+	// Load or re-load the themes of several systems, in parallel when threaded loading is enabled.
+	static void loadThemes(const std::vector<SystemData*>& systems);
 
 	FileFilterIndex* getIndex(bool createIndex);
 	void setIndex(FileFilterIndex* index) { mFilterIndex = index; }
@@ -177,6 +180,9 @@ public:
 	void setGamelistHash(size_t size) { mGameListHash = size; }
 	size_t getGamelistHash() { return mGameListHash; }
 
+	const std::shared_ptr<GamelistIndex>& getGamelistIndex() const { return mGamelistIndex; }
+	void setGamelistIndex(const std::shared_ptr<GamelistIndex>& index) { mGamelistIndex = index; }
+
 	bool isNetplaySupported();
 	bool isCheevosSupported();
 
@@ -236,6 +242,7 @@ private:
 	static void createGroupedSystems();
 
 	size_t mGameListHash;
+	std::shared_ptr<GamelistIndex> mGamelistIndex;
 
 	bool mIsCollectionSystem;
 	bool mIsGameSystem;
@@ -518,7 +518,7 @@ void GuiCollectionSystemsOptions::addSystemsToMenu()
 	bool hasGroup = false;
 	bool hasGenreGroup = false;
 
-	auto arcadeGames = CollectionSystemManager::get()->getArcadeCollection()->getRootFolder()->getFilesRecursive(GAME);
+	auto arcadeGames = CollectionSystemManager::get()->getAutoCollectionGames("arcade");
 
 	// add Auto Systems && preserve order
 	for (auto systemDecl : CollectionSystemManager::getSystemDecls())
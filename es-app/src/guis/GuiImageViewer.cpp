@@ -4,6 +4,11 @@
 #include "ApiSystem.h"
 #include "GuiLoading.h"
 #include "ImageIO.h"
+#include "Paths.h"
+#include "Settings.h"
+#include "utils/StringUtil.h"
+#include "utils/TimeUtil.h"
+#include "Log.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -268,13 +273,9 @@ private:
 	bool	 mLocked;
 };
 
-static bool g_isGuiImageViewerRunning = false;
-
 GuiImageViewer::GuiImageViewer(Window* window, bool linearSmooth) :
-	GuiComponent(window), mGrid(window), mPdfThreads(nullptr)
+	GuiComponent(window), mGrid(window), mWantedPage(0), mPageDpi(0), mPageTasks(nullptr), mAlive(std::make_shared<bool>(true))
 {
-	g_isGuiImageViewerRunning = true;
-
 	setPosition(0, 0);
 	setSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
 		
@@ -327,93 +328,282 @@ GuiImageViewer::GuiImageViewer(Window* window, bool linearSmooth) :
 	animateTo(Vector2f(0, Renderer::getScreenHeight()), Vector2f(0, 0));
 }
 
-void GuiImageViewer::loadPdf(const std::string& imagePath)
+#define PREFETCH_PAGES	4
+
+enum PageState : unsigned char
 {
-	Window* window = mWindow;
+	PAGE_NONE,
+	PAGE_QUEUED,
+	PAGE_READY,
+	PAGE_FAILED
+};
 
-	int pages = ApiSystem::getInstance()->getPdfPageCount(imagePath);
-	if (pages == 0)
+static std::string getPageCacheRoot()
+{
+	return Paths::getUserEmulationStationPath() + "/cache/pages";
+}
+
+static std::string getPageFileName(int index)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "page-%05d", index + 1);
+	return buffer;
+}
+
+// Pages are cached per document version and resolution, so an edited document or another screen size starts over
+static std::string getPageCachePath(const std::string& documentPath, int dpi)
+{
+	std::string key = documentPath + "|" +
+		std::to_string(Utils::FileSystem::getFileSize(documentPath)) + "|" +
+		std::to_string(Utils::FileSystem::getFileModificationDate(documentPath).getTime()) + "|" +
+		std::to_string(dpi);
+
+	unsigned long long hash = 14695981039346656037ULL; // FNV-1a
+	for (auto c : key)
 	{
-		delete this;
-		return;
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ULL;
 	}
 
-#define INITIALPAGES	1
-#define PAGESPERTHREAD  1
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%016llx", hash);
+	return getPageCacheRoot() + "/" + buffer;
+}
 
-	mPdf = imagePath;
-	
-	for (int i = 0; i < pages; i++)
+// Drops the least recently opened documents until the cache fits in PageCacheSize
+static void trimPageCache(const std::string& keepPath)
+{
+	unsigned long long maxSize = (unsigned long long)std::max(0, Settings::getInstance()->getInt("PageCacheSize")) * 1024 * 1024;
+
+	struct CachedDocument
+	{
+		std::string path;
+		time_t lastUse;
+		unsigned long long size;
+	};
+
+	std::vector<CachedDocument> documents;
+
+	for (auto folder : Utils::FileSystem::getDirContent(getPageCacheRoot(), false))
+	{
+		if (!Utils::FileSystem::isDirectory(folder))
+			continue;
+
+		CachedDocument doc;
+		doc.path = folder;
+		doc.lastUse = Utils::FileSystem::getFileModificationDate(folder + "/last-use").getTime();
+		doc.size = 0;
+
+		for (auto file : Utils::FileSystem::getDirContent(folder, false))
+			doc.size += Utils::FileSystem::getFileSize(file);
+
+		documents.push_back(doc);
+	}
+
+	std::sort(documents.begin(), documents.end(), [keepPath](const CachedDocument& a, const CachedDocument& b)
+	{
+		if (a.path == keepPath || b.path == keepPath)
+			return a.path == keepPath;
+
+		return a.lastUse > b.lastUse;
+	});
+
+	unsigned long long totalSize = 0;
+	for (auto& doc : documents)
+	{
+		totalSize += doc.size;
+		if (totalSize > maxSize && doc.path != keepPath)
+			Utils::FileSystem::deleteDirectoryFiles(doc.path, true);
+	}
+}
+
+void GuiImageViewer::openPages(const std::string& documentPath, int pageCount, int dpi)
+{
+	mPdf = documentPath;
+	mPageDpi = dpi;
+	mPageStates.resize(pageCount, PAGE_NONE);
+	mWantedPage = 0;
+
+	for (int i = 0; i < pageCount; i++)
 		mGrid.add("", ":/blank.png", std::to_string(i + 1));
-	
-	if (pages > INITIALPAGES)
+
+	if (Settings::getInstance()->getInt("PageCacheSize") > 0)
 	{
-		mPdfThreads = new Utils::ThreadPool(1);
+		mPageCachePath = getPageCachePath(documentPath, dpi);
+		Utils::FileSystem::createDirectory(mPageCachePath);
 
-		for (int i = INITIALPAGES; i < pages; i += PAGESPERTHREAD)
+		// Touch the document so it is the last one to be evicted
+		Utils::FileSystem::writeAllText(mPageCachePath + "/last-use", documentPath);
+
+		// Pages rendered by previous sessions are available right away
+		for (auto file : Utils::FileSystem::getDirContent(mPageCachePath, false))
 		{
-			mPdfThreads->queueWorkItem([this, imagePath, window, i]
-			{
-				auto fl = ApiSystem::getInstance()->extractPdfImages(imagePath, i + 1, PAGESPERTHREAD);
-				if (fl.size() == 0 || !g_isGuiImageViewerRunning)
-					return;
+			auto name = Utils::FileSystem::getStem(file);
+			if (!Utils::String::startsWith(name, "page-"))
+				continue;
 
-				window->postToUiThread([this, i, fl]()
-				{
-					if (!g_isGuiImageViewerRunning)
-						return;
-
-					for (int f = 0; f < fl.size(); f++)
-					{
-						auto img = fl[f];
-						ImageIO::removeImageCache(img);
-						mGrid.setImage(img, std::to_string(i + 1 + f));
-					}
-				});
-			});
+			int index = Utils::String::toInteger(name.substr(5)) - 1;
+			if (index >= 0 && index < pageCount)
+				showPage(index, file);
 		}
 
-		mPdfThreads->start();
+		std::string keepPath = mPageCachePath;
+		Utils::TaskScheduler::run([keepPath] { trimPageCache(keepPath); });
 	}
-	
-	window->pushGui(new GuiLoading<std::vector<std::string>>(window, _("Loading..."),
-		[window, imagePath](auto gui)
-		{		
-			return ApiSystem::getInstance()->extractPdfImages(imagePath, 1, INITIALPAGES);
+	else
+	{
+		mPageCachePath = Utils::FileSystem::getPdfTempPath() + "/pages";
+		Utils::FileSystem::createDirectory(mPageCachePath);
+	}
+
+	mPageTasks = new Utils::TaskGroup(2, Utils::TaskScheduler::INTERACTIVE);
+	mGrid.setCursorChangedCallback([this](CursorState state) { requestPages(mGrid.getCursorIndex()); });
+
+	Window* window = mWindow;
+
+	if (mPageStates[0] == PAGE_READY)
+	{
+		requestPages(0);
+		window->pushGui(this);
+		return;
+	}
+
+	window->pushGui(new GuiLoading<std::string>(window, _("Loading..."),
+		[this](auto gui)
+		{
+			return renderPage(0);
 		},
-			[this, window, imagePath, pages](std::vector<std::string> fileList)
+		[this, window](std::string file)
 		{
-			if (fileList.size() == 0)
-				return;
-		
-			for (int i = 0; i < fileList.size(); i++)
+			if (file.empty())
 			{
-				ImageIO::removeImageCache(fileList[i]);
-				mGrid.setImage(fileList[i], std::to_string(i + 1));
+				delete this;
+				return;
 			}
 
+			showPage(0, file);
+			requestPages(0);
 			window->pushGui(this);
 		}));
 }
 
-static std::string _extractZipFile(const std::string& zipFileName, const std::string& fileToExtract)
+void GuiImageViewer::showPage(int index, const std::string& file)
 {
-	auto pdfFolder = Utils::FileSystem::getPdfTempPath();
+	{
+		std::unique_lock<std::mutex> lock(mPageLock);
+		mPageStates[index] = PAGE_READY;
+	}
+
+	ImageIO::removeImageCache(file);
+	mGrid.setImage(file, std::to_string(index + 1));
+}
+
+// Queues the pages around the cursor, nearest first. Queued pages that went out of the window are skipped when they start.
+void GuiImageViewer::requestPages(int cursor)
+{
+	int count = (int)mPageStates.size();
+	if (count == 0 || mPageTasks == nullptr)
+		return;
+
+	mWantedPage = cursor;
+
+	std::unique_lock<std::mutex> lock(mPageLock);
+
+	for (int distance = 0; distance <= PREFETCH_PAGES && distance < count; distance++)
+	{
+		for (int direction : { 1, -1 })
+		{
+			// The grid loops, so the page before the first one is the last one
+			int index = ((cursor + direction * distance) % count + count) % count;
+			if (mPageStates[index] != PAGE_NONE)
+				continue;
+
+			mPageStates[index] = PAGE_QUEUED;
+			mPageTasks->run([this, index] { renderPageTask(index); });
+		}
+	}
+}
 
-	Utils::Zip::ZipFile zipFile;
-	if (zipFile.load(zipFileName))
+void GuiImageViewer::renderPageTask(int index)
+{
+	int count = (int)mPageStates.size();
+	int distance = std::abs(index - mWantedPage);
+	distance = std::min(distance, count - distance);
+
+	if (distance > PREFETCH_PAGES)
 	{
-		std::string fullPath = Utils::FileSystem::combine(pdfFolder, fileToExtract);
-		std::string folder = Utils::FileSystem::getParent(fullPath);
-		if (folder != pdfFolder)
-			Utils::FileSystem::createDirectory(folder);
+		std::unique_lock<std::mutex> lock(mPageLock);
+		mPageStates[index] = PAGE_NONE;
+		return;
+	}
 
-		if (zipFile.extract(fileToExtract, fullPath, true))
-			if (Utils::FileSystem::exists(fullPath))
-				return fullPath;
+	std::string file = renderPage(index);
+	if (file.empty())
+	{
+		std::unique_lock<std::mutex> lock(mPageLock);
+		mPageStates[index] = PAGE_FAILED;
+		return;
 	}
 
-	return "";
+	std::shared_ptr<bool> alive = mAlive;
+
+	mWindow->postToUiThread([this, alive, index, file]()
+	{
+		if (*alive)
+			showPage(index, file);
+	});
+}
+
+// Runs on a worker : renders or extracts one page into the page cache, and returns the file
+std::string GuiImageViewer::renderPage(int index)
+{
+	std::string cacheFile = mPageCachePath + "/" + getPageFileName(index);
+
+	if (!mPageNames.empty())
+	{
+		cacheFile += Utils::String::toLower(Utils::FileSystem::getExtension(mPageNames[index]));
+		if (Utils::FileSystem::exists(cacheFile))
+			return cacheFile;
+
+		Utils::Zip::ZipFile zipFile;
+		if (zipFile.load(mPdf) && zipFile.extract(mPageNames[index], cacheFile, true) && Utils::FileSystem::exists(cacheFile))
+			return cacheFile;
+
+		return "";
+	}
+
+	StopWatch watch("GuiImageViewer::renderPage " + std::to_string(index + 1), LogDebug);
+
+	auto files = ApiSystem::getInstance()->extractPdfImages(mPdf, index + 1, 1, mPageDpi);
+	if (files.size() == 0)
+		return "";
+
+	cacheFile += Utils::String::toLower(Utils::FileSystem::getExtension(files[0]));
+	if (Utils::FileSystem::renameFile(files[0], cacheFile, true))
+		return cacheFile;
+
+	// The cache may be on another volume than the temp folder
+	if (Utils::FileSystem::copyFile(files[0], cacheFile))
+	{
+		Utils::FileSystem::removeFile(files[0]);
+		return cacheFile;
+	}
+
+	return files[0];
+}
+
+void GuiImageViewer::loadPdf(const std::string& imagePath)
+{
+	int pages = ApiSystem::getInstance()->getPdfPageCount(imagePath);
+	if (pages == 0)
+	{
+		delete this;
+		return;
+	}
+
+	// Render at the screen resolution : a 11 inches high page fills the screen height
+	int dpi = std::max(48, std::min(300, Renderer::getScreenHeight() / 11));
+	openPages(imagePath, pages, dpi);
 }
 
 void GuiImageViewer::loadImages(std::vector<std::string>& images)
@@ -437,15 +627,7 @@ void GuiImageViewer::loadImages(std::vector<std::string>& images)
 
 void GuiImageViewer::loadCbz(const std::string& imagePath)
 {
-	auto pdfFolder = Utils::FileSystem::getPdfTempPath();
-	Utils::FileSystem::createDirectory(pdfFolder);
-	Utils::FileSystem::deleteDirectoryFiles(pdfFolder);
-
-	Window* window = mWindow;
-
 	std::vector<std::string> files;
-	std::vector<std::wstring> filesW;
-	
 
 	try
 	{
@@ -474,88 +656,26 @@ void GuiImageViewer::loadCbz(const std::string& imagePath)
 		return;
 	}
 
-	int pages = files.size();
-	if (pages == 0)
+	if (files.size() == 0)
 	{
 		delete this;
 		return;
 	}
 
-#define INITIALPAGES	1
-
-	mPdf = imagePath;
-
-	for (int i = 0; i < pages; i++)
-		mGrid.add("", ":/blank.png", std::to_string(i + 1));
-
-	if (pages > INITIALPAGES)
-	{
-		mPdfThreads = new Utils::ThreadPool(1);
-
-		for (int i = INITIALPAGES; i < pages; i += PAGESPERTHREAD)
-		{
-			auto fileToExtract = files[i];
-			mPdfThreads->queueWorkItem([this, imagePath, fileToExtract, window, i]
-			{
-				auto localFile = _extractZipFile(imagePath, fileToExtract);
-				if (localFile.empty() || !g_isGuiImageViewerRunning)
-					return;
-
-				window->postToUiThread([this, i, localFile]()
-				{
-					if (!g_isGuiImageViewerRunning)
-						return;
-
-					ImageIO::removeImageCache(localFile);
-					mGrid.setImage(localFile, std::to_string(i + 1));
-				});
-			});
-		}
-
-		mPdfThreads->start();
-	}
-
-	window->pushGui(new GuiLoading<std::vector<std::string>>(window, _("Loading..."),
-		[window, imagePath, files](auto gui)
-		{
-			std::vector<std::string> ret;
-
-			for (size_t i = 0; i < INITIALPAGES && i < files.size(); i++)
-			{
-				auto fileToExtract = files[i];
-
-				auto localFile = _extractZipFile(imagePath, fileToExtract);
-				if (!localFile.empty())
-					ret.push_back(localFile);
-			}
-
-			return ret;
-		},
-		[this, window, imagePath, pages](std::vector<std::string> fileList)
-		{
-			if (fileList.size() == 0)
-				return;
-
-			for (size_t i = 0; i < fileList.size(); i++)
-			{
-				ImageIO::removeImageCache(fileList[i]);
-				mGrid.setImage(fileList[i], std::to_string(i + 1));
-			}
-
-			window->pushGui(this);
-		}
-	));
+	mPageNames = files;
+	openPages(imagePath, (int)files.size(), 0);
 }
 
 
 GuiImageViewer::~GuiImageViewer()
 {
-	g_isGuiImageViewerRunning = false;
+	// Pages posted to the UI thread by tasks that were already running must not reach a deleted viewer
+	*mAlive = false;
 
-	if (mPdfThreads != nullptr)
+	if (mPageTasks != nullptr)
 	{
-		mPdfThreads->stop();
-		delete mPdfThreads;
+		mPageTasks->cancel();
+		delete mPageTasks;
 	}
 
 	auto pdfFolder = Utils::FileSystem::getPdfTempPath();
@@ -3,7 +3,9 @@
 #include "GuiComponent.h"
 #include "Window.h"
 #include "components/ImageGridComponent.h"
-#include "utils/ThreadPool.h"
+#include "utils/TaskScheduler.h"
+#include <mutex>
+#include <atomic>
 
 class ThemeData;
 class VideoComponent;
@@ -30,11 +32,26 @@ protected:
 	void loadCbz(const std::string& imagePath);
 	void loadImages(std::vector<std::string>& images);
 
+	// Document pages are rendered around the cursor in the background, and kept in a disk cache between sessions
+	void openPages(const std::string& documentPath, int pageCount, int dpi);
+	void requestPages(int cursor);
+	void renderPageTask(int index);
+	std::string renderPage(int index);
+	void showPage(int index, const std::string& file);
+
 	ImageGridComponent<std::string> mGrid;
 	std::shared_ptr<ThemeData> mTheme;
 	std::string mPdf;
 
-	Utils::ThreadPool* mPdfThreads;
+	std::vector<std::string>	mPageNames; // CBZ : archive entry of each page
+	std::vector<unsigned char>	mPageStates;
+	std::mutex					mPageLock;
+	std::atomic<int>			mWantedPage;
+	std::string					mPageCachePath;
+	int							mPageDpi;
+
+	Utils::TaskGroup*			mPageTasks;
+	std::shared_ptr<bool>		mAlive; // Only read and written on the UI thread
 };
 
 class GuiVideoViewer : public GuiComponent
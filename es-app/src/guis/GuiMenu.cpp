@@ -118,11 +118,47 @@
 #define fake_gettext_resolution_max_1K  _("maximum 1920x1080")
 #define fake_gettext_resolution_max_640 _("maximum 640x480")
 
+// Fills an option list with the result of an ApiSystem query. If the query is still running, a "PLEASE WAIT" entry is displayed
+// and the list is filled on the UI thread as soon as the result is available.
+template<typename T>
+static void fillOptionListWhenReady(Window* window, const std::shared_ptr<OptionListComponent<std::string>>& list, const std::shared_future<T>& result, const std::function<void(const T&)>& fill)
+{
+	if (ApiSystem::isQueryReady(result))
+	{
+		fill(result.get());
+		return;
+	}
+
+	list->add(_("PLEASE WAIT"), "", true);
+
+	ApiSystem::getInstance()->onQueryReady<T>(window, result, [list, fill](const T& value)
+	{
+		list->clear();
+		fill(value);
+		list->invalidate();
+	});
+}
+
+// Menus built from the result of an ApiSystem query : if the query is still running, a busy screen is displayed and 'open' is called
+// again once the result is available. Returns true in that case.
+template<typename T>
+static bool waitForQuery(Window* window, const std::shared_future<T>& result, const std::function<void()>& open)
+{
+	if (ApiSystem::isQueryReady(result))
+		return false;
+
+	window->pushGui(new GuiLoading<T>(window, _("PLEASE WAIT"), [result](IGuiLoadingHandler* gui) { return result.get(); }, [open](T value) { open(); }));
+	return true;
+}
+
 GuiMenu::GuiMenu(Window *window, bool animate) : GuiComponent(window), mMenu(window, _("MAIN MENU").c_str()), mVersion(window)
 {
 	// MAIN MENU
 	bool isFullUI = !UIModeController::getInstance()->isUIModeKid() && !UIModeController::getInstance()->isUIModeKiosk();
 
+	// Start the slow enumerations now, submenus will most likely find them ready
+	ApiSystem::getInstance()->prefetchMenuQueries();
+
 	// KODI >
 	// GAMES SETTINGS >
 	// CONTROLLER & BLUETOOTH >
@@ -400,9 +436,13 @@ void GuiMenu::openSystemInformations()
 
 void GuiMenu::openServicesSettings()
 {
+	auto query = ApiSystem::getInstance()->getServicesAsync();
+	if (waitForQuery(mWindow, query, [this] { openServicesSettings(); }))
+		return;
+
 	auto s = new GuiSettings(mWindow, _("SERVICES").c_str());
 
-	auto services = ApiSystem::getInstance()->getServices();
+	auto services = query.get();
 	for(unsigned int i = 0; i < services.size(); i++) {
 	  auto service_enabled = std::make_shared<SwitchComponent>(mWindow);
 	  service_enabled->setState(services[i].enabled);
@@ -418,11 +458,15 @@ void GuiMenu::openServicesSettings()
 
 void GuiMenu::openDmdSettings()
 {
+	auto query = ApiSystem::getInstance()->getServicesAsync();
+	if (waitForQuery(mWindow, query, [this] { openDmdSettings(); }))
+		return;
+
 	auto s = new GuiSettings(mWindow, _("DMD").c_str());
 	Window* window = mWindow;
 
 	// server
-	auto services = ApiSystem::getInstance()->getServices();
+	auto services = query.get();
 	std::string current_server = "";
 	for(unsigned int i = 0; i < services.size(); i++) {
 	  if(services[i].enabled) {
@@ -500,6 +544,12 @@ void GuiMenu::openDmdSettings()
 
 void GuiMenu::openMultiScreensSettings()
 {
+#ifdef BATOCERA
+	auto videoOutputs = ApiSystem::getInstance()->getAvailableVideoOutputDevicesAsync();
+	if (waitForQuery(mWindow, videoOutputs, [this] { openMultiScreensSettings(); }))
+		return;
+#endif
+
 	auto s = new GuiSettings(mWindow, _("MULTISCREENS").c_str());
 	Window* window = mWindow;
 
@@ -507,7 +557,7 @@ void GuiMenu::openMultiScreensSettings()
 	s->addGroup(_("BACKGLASS / INFORMATION SCREEN"));
 	
 	// video device2
-	std::vector<std::string> availableVideo2 = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
+	std::vector<std::string> availableVideo2 = videoOutputs.get();
 	if (availableVideo2.size())
 	{
 	        if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::BACKGLASS)) {
@@ -608,7 +658,7 @@ void GuiMenu::openMultiScreensSettings()
 	s->addGroup(_("DMD SCREEN"));
 
 	// video device3
-	std::vector<std::string> availableVideo3 = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
+	std::vector<std::string> availableVideo3 = videoOutputs.get();
 	if (availableVideo3.size())
 	{
 		auto optionsVideo3 = std::make_shared<OptionListComponent<std::string> >(mWindow, _("VIDEO OUTPUT"), false);
@@ -1353,21 +1403,31 @@ void GuiMenu::openSystemSettings()
 	// Timezone
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::ScriptId::TIMEZONES))
 	{
-		VectorEx<std::string> availableTimezones = ApiSystem::getInstance()->getTimezones();
-		if (availableTimezones.size() > 0)
-		{
-			std::string currentTZ = ApiSystem::getInstance()->getCurrentTimezone();
-			if (currentTZ.empty() || !availableTimezones.any([currentTZ](const std::string& tz) { return tz == currentTZ; }))
-				currentTZ = "Europe/Paris";
+		auto timezones = ApiSystem::getInstance()->getTimezonesAsync();
+		bool ready = ApiSystem::isQueryReady(timezones);
 
+		if (!ready || timezones.get().size() > 0)
+		{
 			auto tzChoices = std::make_shared<OptionListComponent<std::string> >(mWindow, _("SELECT YOUR TIME ZONE"), false);
 
-			for (auto tz : availableTimezones)
-				tzChoices->add(_(Utils::String::toUpper(tz).c_str()), tz, currentTZ == tz);
+			fillOptionListWhenReady<std::vector<std::string>>(mWindow, tzChoices, timezones, [tzChoices](const std::vector<std::string>& list)
+			{
+				VectorEx<std::string> availableTimezones = list;
+
+				std::string currentTZ = ApiSystem::getInstance()->getCurrentTimezone();
+				if (currentTZ.empty() || !availableTimezones.any([currentTZ](const std::string& tz) { return tz == currentTZ; }))
+					currentTZ = "Europe/Paris";
+
+				for (auto tz : availableTimezones)
+					tzChoices->add(_(Utils::String::toUpper(tz).c_str()), tz, currentTZ == tz);
+			});
 
 			s->addWithLabel(_("TIME ZONE"), tzChoices);
 			s->addSaveFunc([tzChoices] 
 			{
+				if (tzChoices->getSelected().empty())
+					return;
+
 				if (SystemConf::getInstance()->set("system.timezone", tzChoices->getSelected()))
 					ApiSystem::getInstance()->setTimezone(tzChoices->getSelected());
 			});
@@ -1471,28 +1531,31 @@ void GuiMenu::openSystemSettings()
 
 #ifdef BATOCERA
 	// video device
-	std::vector<std::string> availableVideo = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
-	if (availableVideo.size())
+	auto videoOutputs = ApiSystem::getInstance()->getAvailableVideoOutputDevicesAsync();
+	if (!ApiSystem::isQueryReady(videoOutputs) || videoOutputs.get().size())
 	{
 		auto optionsVideo = std::make_shared<OptionListComponent<std::string> >(mWindow, _("VIDEO OUTPUT"), false);
 		std::string currentDevice = SystemConf::getInstance()->get("global.videooutput");
 		if (currentDevice.empty()) currentDevice = "auto";
 
-		bool vfound = false;
-		for (auto it = availableVideo.begin(); it != availableVideo.end(); it++)
+		fillOptionListWhenReady<std::vector<std::string>>(mWindow, optionsVideo, videoOutputs, [optionsVideo, currentDevice](const std::vector<std::string>& availableVideo)
 		{
-			optionsVideo->add((*it), (*it), currentDevice == (*it));
-			if (currentDevice == (*it))
-				vfound = true;
-		}
+			bool vfound = false;
+			for (auto it = availableVideo.begin(); it != availableVideo.end(); it++)
+			{
+				optionsVideo->add((*it), (*it), currentDevice == (*it));
+				if (currentDevice == (*it))
+					vfound = true;
+			}
 
-		if (!vfound)
-			optionsVideo->add(currentDevice, currentDevice, true);
+			if (!vfound)
+				optionsVideo->add(currentDevice, currentDevice, true);
+		});
 
 		s->addWithLabel(_("VIDEO OUTPUT"), optionsVideo);
 		s->addSaveFunc([this, optionsVideo, currentDevice, s] 
 		{
-			if (optionsVideo->changed()) 
+			if (optionsVideo->changed() && !optionsVideo->getSelected().empty()) 
 			{
 				SystemConf::getInstance()->set("global.videooutput", optionsVideo->getSelected());
 				SystemConf::getInstance()->saveSystemConf();				
@@ -1511,8 +1574,8 @@ void GuiMenu::openSystemSettings()
 
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::AUDIODEVICE))
 	{
-		std::vector<std::string> availableAudio = ApiSystem::getInstance()->getAvailableAudioOutputDevices();
-		if (availableAudio.size())
+		auto audioOutputs = ApiSystem::getInstance()->getAvailableAudioOutputDevicesAsync();
+		if (!ApiSystem::isQueryReady(audioOutputs) || audioOutputs.get().size())
 		{
 			// audio device
 			auto optionsAudio = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO OUTPUT"), false);
@@ -1521,37 +1584,40 @@ void GuiMenu::openSystemSettings()
 			if (selectedAudio.empty())
 				selectedAudio = "auto";
 
-			bool afound = false;
-			for (auto it = availableAudio.begin(); it != availableAudio.end(); it++)
+			fillOptionListWhenReady<std::vector<std::string>>(mWindow, optionsAudio, audioOutputs, [optionsAudio, selectedAudio](const std::vector<std::string>& availableAudio)
 			{
-				std::vector<std::string> tokens = Utils::String::split(*it, '\t');
+				bool afound = false;
+				for (auto it = availableAudio.begin(); it != availableAudio.end(); it++)
+				{
+					std::vector<std::string> tokens = Utils::String::split(*it, '\t');
 
-				if (selectedAudio == tokens.at(0))
-					afound = true;
+					if (selectedAudio == tokens.at(0))
+						afound = true;
 
-				if (tokens.size() >= 2)
-				{
-					// concatenat the ending words
-					std::string vname = "";
-					for (unsigned int i = 1; i < tokens.size(); i++)
+					if (tokens.size() >= 2)
 					{
-						if (i > 2) vname += " ";
-						vname += tokens.at(i);
+						// concatenat the ending words
+						std::string vname = "";
+						for (unsigned int i = 1; i < tokens.size(); i++)
+						{
+							if (i > 2) vname += " ";
+							vname += tokens.at(i);
+						}
+						optionsAudio->add(vname, tokens.at(0), selectedAudio == tokens.at(0));
 					}
-					optionsAudio->add(vname, tokens.at(0), selectedAudio == tokens.at(0));
+					else
+						optionsAudio->add((*it), (*it), selectedAudio == tokens.at(0));
 				}
-				else
-					optionsAudio->add((*it), (*it), selectedAudio == tokens.at(0));
-			}
 
-			if (!afound)
-				optionsAudio->add(selectedAudio, selectedAudio, true);
+				if (!afound)
+					optionsAudio->add(selectedAudio, selectedAudio, true);
+			});
 
 			s->addWithLabel(_("AUDIO OUTPUT"), optionsAudio);
 
 			s->addSaveFunc([this, optionsAudio, selectedAudio]
 			{
-				if (optionsAudio->changed())
+				if (optionsAudio->changed() && !optionsAudio->getSelected().empty())
 				{
 					SystemConf::getInstance()->set("audio.device", optionsAudio->getSelected());
 					ApiSystem::getInstance()->setAudioOutputDevice(optionsAudio->getSelected());
@@ -1888,47 +1954,50 @@ void GuiMenu::openSystemSettings()
 	s->addGroup(_("STORAGE"));
 
 	// Storage device
-	std::vector<std::string> availableStorage = ApiSystem::getInstance()->getAvailableStorageDevices();
-	if (availableStorage.size())
+	auto storageDevices = ApiSystem::getInstance()->getAvailableStorageDevicesAsync();
+	if (!ApiSystem::isQueryReady(storageDevices) || storageDevices.get().size())
 	{		
 		std::string selectedStorage = ApiSystem::getInstance()->getCurrentStorage();
 
 		auto optionsStorage = std::make_shared<OptionListComponent<std::string> >(window, _("STORAGE DEVICE"), false);
-		for (auto it = availableStorage.begin(); it != availableStorage.end(); it++)
+		fillOptionListWhenReady<std::vector<std::string>>(window, optionsStorage, storageDevices, [optionsStorage, selectedStorage](const std::vector<std::string>& availableStorage)
 		{
-				if (Utils::String::startsWith(*it, "DEV"))
-				{
-					std::vector<std::string> tokens = Utils::String::split(*it, ' ');
-
-					if (tokens.size() >= 3) {
-						// concatenat the ending words
-						std::string vname = "";
-						for (unsigned int i = 2; i < tokens.size(); i++) {
-							if (i > 2) vname += " ";
-							vname += tokens.at(i);
+			for (auto it = availableStorage.begin(); it != availableStorage.end(); it++)
+			{
+					if (Utils::String::startsWith(*it, "DEV"))
+					{
+						std::vector<std::string> tokens = Utils::String::split(*it, ' ');
+
+						if (tokens.size() >= 3) {
+							// concatenat the ending words
+							std::string vname = "";
+							for (unsigned int i = 2; i < tokens.size(); i++) {
+								if (i > 2) vname += " ";
+								vname += tokens.at(i);
+							}
+							optionsStorage->add(vname, (*it), selectedStorage == std::string("DEV " + tokens.at(1)));
 						}
-						optionsStorage->add(vname, (*it), selectedStorage == std::string("DEV " + tokens.at(1)));
+					} else {
+					  std::vector<std::string> tokens = Utils::String::split(*it, ' ');
+					  if (tokens.size() == 1) {
+						optionsStorage->add((*it), (*it), selectedStorage == (*it));
+					  } else {
+					    // concatenat the ending words
+					    std::string vname = "";
+					    for (unsigned int i = 1; i < tokens.size(); i++) {
+					      if (i > 1) vname += " ";
+					      vname += tokens.at(i);
+					    }
+					    optionsStorage->add(_(vname.c_str()), tokens.at(0), selectedStorage == tokens.at(0));
+					  }
 					}
-				} else {
-				  std::vector<std::string> tokens = Utils::String::split(*it, ' ');
-				  if (tokens.size() == 1) {
-					optionsStorage->add((*it), (*it), selectedStorage == (*it));
-				  } else {
-				    // concatenat the ending words
-				    std::string vname = "";
-				    for (unsigned int i = 1; i < tokens.size(); i++) {
-				      if (i > 1) vname += " ";
-				      vname += tokens.at(i);
-				    }
-				    optionsStorage->add(_(vname.c_str()), tokens.at(0), selectedStorage == tokens.at(0));
-				  }
-				}
-		}
+			}
+		});
 
 		s->addWithLabel(_("STORAGE DEVICE"), optionsStorage);
 		s->addSaveFunc([optionsStorage, selectedStorage, s]
 		{
-			if (optionsStorage->changed())
+			if (optionsStorage->changed() && !optionsStorage->getSelected().empty())
 			{
 				ApiSystem::getInstance()->setStorage(optionsStorage->getSelected());
 				s->setVariable("reboot", true);
@@ -1980,8 +2049,13 @@ void GuiMenu::openSystemSettings()
 	{
 		s->addGroup(_("ADVANCED"));
 
-		if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::SERVICES) && ApiSystem::getInstance()->getServices().size())
-			s->addEntry(_("SERVICES"), true, [this] { openServicesSettings(); });
+		if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::SERVICES))
+		{
+			// Until the services are known, keep the entry : openServicesSettings waits for them
+			auto services = ApiSystem::getInstance()->getServicesAsync();
+			if (!ApiSystem::isQueryReady(services) || services.get().size())
+				s->addEntry(_("SERVICES"), true, [this] { openServicesSettings(); });
+		}
 	}
 #endif
 	
@@ -1,7 +1,6 @@
 #include "GuiNetPlay.h"
 #include "Window.h"
 #include <string>
-#include <future>
 #include <fcntl.h>
 #include "Log.h"
 #include "Settings.h"
@@ -12,6 +11,7 @@
 #include "guis/GuiMsgBox.h"
 #include "SystemData.h"
 #include "FileData.h"
+#include "NetPlayIndex.h"
 #include "ThemeData.h"
 #include "components/MenuComponent.h"
 #include "components/ButtonComponent.h"
@@ -478,14 +478,8 @@ std::vector<HelpPrompt> GuiNetPlay::getHelpPrompts()
 
 FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string coreName)
 {
-	auto normalizeName = [](const std::string name)
-	{
-		auto ret = Utils::String::toLower(name);
-		ret = Utils::String::replace(ret, "_", " ");
-		ret = Utils::String::replace(ret, ".", "");
-		ret = Utils::String::replace(ret, "'", "");
-		return Utils::String::removeParenthesis(ret);
-	};
+	if (crc)
+		return NetPlayIndex::findByCrc(gameInfo);
 
 	std::string lowCore;
 
@@ -494,69 +488,8 @@ FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string co
 		lowCore = Utils::String::toLower(coreInfo->second);
 	else
 		lowCore = Utils::String::toLower(Utils::String::replace(coreName, " ", "_"));
-	
-	std::string normalizedName = normalizeName(gameInfo);
-	std::string normalizedNameNoSpace = Utils::String::replace(normalizedName, " ", "");
-
-	std::vector<std::future<FileData*>> futures;
-	for (auto sys : SystemData::sSystemVector)
-	{
-		if (!sys->isNetplaySupported())
-			continue;
-
-		if (!crc)
-		{
-			bool coreExists = false;
-
-			for (auto& emul : sys->getEmulators())
-				for (auto& core : emul.cores)
-					if (Utils::String::toLower(core.name) == lowCore)
-					{
-						coreExists = true;
-						break;
-					}
-
-			if (!coreExists)
-				continue;
-		}
-
-		futures.push_back(std::async(std::launch::async, [sys, crc, gameInfo, normalizedName, normalizedNameNoSpace, &normalizeName]() -> FileData* {
-			for (auto file : sys->getRootFolder()->getFilesRecursive(GAME, false, sys))
-			{
-				if (crc)
-				{
-					if (file->getMetadata(MetaDataId::Crc32) == gameInfo)
-						return file;
-
-					continue;
-				}
-				else
-				{
-					std::string stem = normalizeName(file->getName());
-					if (stem == normalizedName)
-						return file;
-
-					stem = normalizeName(Utils::FileSystem::getStem(file->getPath()));
-					if (stem == normalizedName)
-						return file;
-
-					stem = Utils::String::replace(normalizeName(file->getName()), " ", "");
-					if (stem == Utils::String::replace(normalizedName, " ", ""))
-						return file;
-				}
-			}
-			return nullptr;
-		}));
-	}
-
-	for (auto& fut : futures)
-	{
-		FileData* file = fut.get();
-		if (file != nullptr)
-			return file;
-	}
 
-	return nullptr;
+	return NetPlayIndex::findByName(gameInfo, lowCore);
 }
 
 class NetPlayLobbyListEntry : public ComponentGrid
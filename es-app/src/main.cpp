@@ -13,6 +13,7 @@
 #include "MameNames.h"
 #include "Genres.h"
 #include "utils/Platform.h"
+#include "utils/TaskScheduler.h"
 #include "PowerSaver.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -29,6 +30,7 @@
 #include "NetworkThread.h"
 #include "scrapers/ThreadedScraper.h"
 #include "ThreadedHasher.h"
+#include "Gamelist.h"
 #include <FreeImage.h>
 #include "ImageIO.h"
 #include "components/VideoVlcComponent.h"
@@ -657,6 +659,7 @@ int main(int argc, char* argv[])
 
 	int lastTime = SDL_GetTicks();
 	int ps_time = SDL_GetTicks();
+	int lastGamelistSave = SDL_GetTicks();
 
 	bool running = true;
 
@@ -720,6 +723,19 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
+		// Save changed metadata in the background, so there's nothing left to write when exiting
+		if (curTime - lastGamelistSave >= 1000)
+		{
+			int saveInterval = Settings::GamelistSaveInterval();
+			if (saveInterval <= 0)
+				lastGamelistSave = curTime;
+			else if (curTime - lastGamelistSave >= saveInterval * 1000)
+			{
+				lastGamelistSave = curTime;
+				TRYCATCH("updateDirtyGamelists", updateDirtyGamelists(true))
+			}
+		}
+
 		TRYCATCH("Window.update" ,window.update(deltaTime))	
 		TRYCATCH("Window.render", window.render())
 
@@ -747,6 +763,7 @@ int main(int argc, char* argv[])
 	ThreadedHasher::stop();
 	ThreadedScraper::stop();
 
+	ApiSystem::getInstance()->stopQueries();
 	ApiSystem::getInstance()->deinit();
 
 	while (window.peekGui() != ViewController::get())
@@ -761,6 +778,7 @@ int main(int argc, char* argv[])
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
 	Scripting::exitScriptingEngine();
+	Utils::TaskScheduler::stop();
 
 	// call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
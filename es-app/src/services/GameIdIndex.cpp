@@ -0,0 +1,121 @@
+#include "GameIdIndex.h"
+
+#include "SystemData.h"
+#include "FileData.h"
+#include "utils/md5.h"
+#include <stack>
+
+std::unordered_map<FileData*, std::string>			GameIdIndex::mIds;
+std::unordered_map<SystemData*, GameIdIndex::SystemMap>	GameIdIndex::mSystems;
+std::mutex											GameIdIndex::mLock;
+
+const std::string& GameIdIndex::getIdLocked(FileData* game)
+{
+	auto it = mIds.find(game);
+	if (it != mIds.cend())
+		return it->second;
+
+	MD5 md5;
+	md5.update(game->getPath().c_str(), game->getPath().size());
+	md5.finalize();
+
+	return mIds[game] = md5.hexdigest();
+}
+
+std::string GameIdIndex::getId(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return getIdLocked(game);
+}
+
+void GameIdIndex::buildSystemMap(SystemData* system, SystemMap& map)
+{
+	// Read before the walk : files added meanwhile are seen by the next rebuild
+	map.treeGeneration = FolderData::getTreeGeneration();
+	map.ids.clear();
+
+	std::stack<FolderData*> stack;
+	stack.push(system->getRootFolder());
+
+	while (stack.size())
+	{
+		FolderData* current = stack.top();
+		stack.pop();
+
+		for (auto it : current->getChildren())
+		{
+			if (it->getType() == FOLDER)
+				stack.push((FolderData*)it);
+			else
+				map.ids.emplace(getIdLocked(it), it); // Keeps the first game found for an id, like the sequential search
+		}
+	}
+}
+
+bool GameIdIndex::belongsTo(FileData* game, SystemData* system)
+{
+	FolderData* root = system->getRootFolder();
+
+	for (FolderData* folder = game->getParent(); folder != nullptr; folder = folder->getParent())
+		if (folder == root)
+			return true;
+
+	return false;
+}
+
+FileData* GameIdIndex::find(SystemData* system, const std::string& id)
+{
+	if (system == nullptr || system->getRootFolder() == nullptr)
+		return nullptr;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto sys = mSystems.find(system);
+	if (sys == mSystems.cend())
+	{
+		sys = mSystems.emplace(system, SystemMap()).first;
+		buildSystemMap(system, sys->second);
+	}
+
+	auto it = sys->second.ids.find(id);
+	if (it != sys->second.ids.cend() && belongsTo(it->second, system))
+		return it->second;
+
+	// Nothing was added to the tree since the map was built : the id is unknown, or its game left the system
+	if (sys->second.treeGeneration == FolderData::getTreeGeneration())
+		return nullptr;
+
+	buildSystemMap(system, sys->second);
+
+	it = sys->second.ids.find(id);
+	if (it != sys->second.ids.cend() && belongsTo(it->second, system))
+		return it->second;
+
+	return nullptr;
+}
+
+void GameIdIndex::remove(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mIds.find(game);
+	if (it == mIds.cend())
+		return;
+
+	for (auto& sys : mSystems)
+	{
+		auto entry = sys.second.ids.find(it->second);
+		if (entry != sys.second.ids.cend() && entry->second == game)
+			sys.second.ids.erase(entry);
+	}
+
+	mIds.erase(it);
+}
+
+void GameIdIndex::reset()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mIds.clear();
+	mSystems.clear();
+}
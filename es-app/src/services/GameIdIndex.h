@@ -0,0 +1,43 @@
+#pragma once
+#ifndef ES_APP_SERVICES_GAME_ID_INDEX_H
+#define ES_APP_SERVICES_GAME_ID_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+class SystemData;
+class FileData;
+
+// Ids of the games exposed by the http api (MD5 of the path), and per system maps from id to game.
+// An id is hashed once per game. A system's map is built on its first lookup. A lookup that misses, or finds a game that
+// left the system, rebuilds it only if files were added to the tree since (FolderData::getTreeGeneration), so unknown ids
+// cost a hash lookup. Deleted games remove themselves.
+class GameIdIndex
+{
+public:
+	static std::string getId(FileData* game);
+	static FileData*   find(SystemData* system, const std::string& id);
+
+	static void remove(FileData* game);
+	static void reset();
+
+private:
+	typedef std::unordered_map<std::string, FileData*> IdMap;
+
+	struct SystemMap
+	{
+		IdMap ids;
+		unsigned int treeGeneration; // FolderData tree generation when the map was built
+	};
+
+	static const std::string& getIdLocked(FileData* game);
+	static void buildSystemMap(SystemData* system, SystemMap& map);
+	static bool belongsTo(FileData* game, SystemData* system);
+
+	static std::unordered_map<FileData*, std::string>	mIds;
+	static std::unordered_map<SystemData*, SystemMap>	mSystems;
+	static std::mutex									mLock;
+};
+
+#endif // ES_APP_SERVICES_GAME_ID_INDEX_H
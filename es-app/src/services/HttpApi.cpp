@@ -11,11 +11,23 @@
 #include "FileData.h"
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
+#include "guis/GuiMenu.h"
+#include "Log.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
-#include "utils/md5.h"
+#include "services/GameIdIndex.h"
 #include "scrapers/Scraper.h"
 #include <unordered_map>
+#include <set>
+#include <unordered_set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <time.h>
+#include <rapidjson/writer.h>
+#include <pugixml/src/pugixml.hpp>
 
 void HttpApi::getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths)
 {
@@ -101,72 +113,83 @@ std::string HttpApi::getSystemList()
 
 std::string HttpApi::getFileDataId(FileData* game)
 {
-	MD5 md5;
-	md5.update(game->getPath().c_str(), game->getPath().size());
-	md5.finalize();
-	return md5.hexdigest();
+	return GameIdIndex::getId(game);
 }
 
 FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
 {
-	std::stack<FolderData*> stack;
-	stack.push(system->getRootFolder());
-
-	while (stack.size())
-	{
-		FolderData* current = stack.top();
-		stack.pop();
+	return GameIdIndex::find(system, id);
+}
 
-		for (auto it : current->getChildren())
-		{			
-			if (it->getType() == FOLDER)
-				stack.push((FolderData*)it);
-			else if (getFileDataId(it) == id)
-				return it;
-		}
-	}
+// Keys and values of a game, in the order they are written
+typedef std::vector<std::pair<std::string, std::string>> FileDataFields;
 
-	return nullptr;
+static std::string getFileDataFieldKey(const MetaDataDecl& mdd)
+{
+	return mdd.id == MetaDataId::ScraperId ? "scraperId" : mdd.key;
 }
 
-void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths)
+// fields : when not null, only these keys are read. Reads the tree : UI thread only
+static void getFileDataFields(FileData* game, const std::string& id, bool localpaths, const std::set<std::string>* fields, FileDataFields& values)
 {
-	if (game->getType() != GAME)
-		return;
-
-	std::string id = getFileDataId(game);
+	auto wanted = [fields](const std::string& key) { return fields == nullptr || fields->find(key) != fields->cend(); };
 
-	writer.StartObject();
-	writer.Key("id"); writer.String(id.c_str());
-	writer.Key("path"); writer.String(game->getPath().c_str());
-	writer.Key("name"); writer.String(game->getName().c_str());
-
-	writer.Key("systemName"); writer.String(game->getSystemName().c_str());
+	if (wanted("id")) values.push_back(std::make_pair("id", id));
+	if (wanted("path")) values.push_back(std::make_pair("path", game->getPath()));
+	if (wanted("name")) values.push_back(std::make_pair("name", game->getName()));
+	if (wanted("systemName")) values.push_back(std::make_pair("systemName", game->getSystemName()));
 
-	auto meta = game->getMetadata();
+	auto& meta = game->getMetadata();
 	for (auto mdd : MetaDataList::getMDD())
 	{
 		if (mdd.id == MetaDataId::Name)
 			continue;
 
+		std::string key = getFileDataFieldKey(mdd);
+		if (!wanted(key))
+			continue;
+
 		std::string value = game->getMetadata(mdd.id);
 		if (!value.empty())
 		{
 			if (meta.getType(mdd.id) == MD_PATH && localpaths == false)
 				value = "/systems/" + game->getSourceFileData()->getSystemName() + "/games/" + id + "/media/" + mdd.key;
 
-			if (mdd.id == MetaDataId::ScraperId)
-				writer.Key("scraperId");
-			else 
-				writer.Key(mdd.key.c_str());
-
-			writer.String(value.c_str());
+			values.push_back(std::make_pair(key, value));
 		}
 	}
+}
+
+template<typename TWriter>
+static void writeFileDataJson(TWriter& writer, const FileDataFields& values)
+{
+	writer.StartObject();
+
+	for (auto& value : values)
+	{
+		writer.Key(value.first.c_str());
+		writer.String(value.second.c_str());
+	}
 
 	writer.EndObject();
 }
 
+template<typename TWriter>
+static void writeFileDataJson(TWriter& writer, FileData* game, const std::string& id, bool localpaths, const std::set<std::string>* fields)
+{
+	FileDataFields values;
+	getFileDataFields(game, id, localpaths, fields, values);
+	writeFileDataJson(writer, values);
+}
+
+void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths)
+{
+	if (game->getType() != GAME)
+		return;
+
+	writeFileDataJson(writer, game, getFileDataId(game), localpaths, nullptr);
+}
+
 bool HttpApi::ImportFromJson(FileData* file, const std::string& json)
 {
 	rapidjson::Document doc;
@@ -280,14 +303,89 @@ std::string HttpApi::ToJson(SystemData* system, bool localpaths)
 	return s.GetString();
 }
 
-std::string HttpApi::getSystemGames(SystemData* system)
+// Game listings are built from immutable snapshots : the compact JSON of each game is kept, and only serialized again
+// when the game's metadata generation moves. The UI thread, which owns the tree, only copies the fields of the changed
+// games ( GameListUpdate ). They are serialized, and the snapshot published, on the http thread.
+struct GameListSnapshot
 {
-	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+	unsigned int generation;
+	unsigned int version;
+	unsigned int lastUse;
 
-	writer.StartArray();
+	std::vector<FileData*>							games;
+	std::vector<std::string>						paths;
+	std::vector<std::shared_ptr<const std::string>>	json;
+};
+
+struct GameListUpdate
+{
+	std::shared_ptr<GameListSnapshot> snapshot;
+	std::vector<std::pair<size_t, FileDataFields>> changes; // Index in snapshot->json, and the fields to serialize there
+	bool isNew;
+};
+
+// One snapshot per system and set of fields : past this amount, the least recently used ones are dropped
+#define MAX_GAMELIST_SNAPSHOTS 32
+
+static std::mutex sGameListsLock;
+static std::map<std::string, std::shared_ptr<GameListSnapshot>> sGameLists;
+static std::atomic<unsigned int> sGameListVersion(0);
+static unsigned int sGameListUse = 0;
+static const unsigned int sGameListEpoch = (unsigned int)time(nullptr);
+
+static std::shared_ptr<GameListSnapshot> getGameListSnapshot(const std::string& key)
+{
+	std::unique_lock<std::mutex> lock(sGameListsLock);
+
+	auto it = sGameLists.find(key);
+	if (it == sGameLists.cend())
+		return nullptr;
+
+	it->second->lastUse = ++sGameListUse;
+	return it->second;
+}
+
+static void publishGameListSnapshot(const std::string& key, const std::shared_ptr<GameListSnapshot>& snapshot)
+{
+	std::unique_lock<std::mutex> lock(sGameListsLock);
 
-	std::vector<FileData*> files;
+	snapshot->lastUse = ++sGameListUse;
+	sGameLists[key] = snapshot;
+
+	while (sGameLists.size() > MAX_GAMELIST_SNAPSHOTS)
+	{
+		auto oldest = sGameLists.begin();
+		for (auto it = sGameLists.begin(); it != sGameLists.end(); ++it)
+			if (it->second->lastUse < oldest->second->lastUse)
+				oldest = it;
+
+		sGameLists.erase(oldest);
+	}
+}
+
+// UI thread
+static std::shared_ptr<GameListUpdate> updateGameListSnapshot(const std::string& key, const std::string& systemName, const std::set<std::string>& fields)
+{
+	SystemData* system = SystemData::getSystem(systemName);
+	if (system == nullptr || system->getRootFolder() == nullptr)
+		return nullptr;
+
+	unsigned int generation = MetaDataList::getGlobalGeneration();
+
+	std::shared_ptr<GameListSnapshot> previous = getGameListSnapshot(key);
+
+	std::unordered_map<FileData*, size_t> previousIndex;
+	if (previous != nullptr)
+		for (size_t i = 0; i < previous->games.size(); i++)
+			previousIndex[previous->games[i]] = i;
+
+	auto update = std::make_shared<GameListUpdate>();
+	update->snapshot = std::make_shared<GameListSnapshot>();
+	update->snapshot->generation = generation;
+
+	GameListSnapshot* snapshot = update->snapshot.get();
+
+	bool changed = (previous == nullptr);
 
 	std::stack<FolderData*> stack;
 	stack.push(system->getRootFolder());
@@ -297,22 +395,345 @@ std::string HttpApi::getSystemGames(SystemData* system)
 		FolderData* current = stack.top();
 		stack.pop();
 
-		for (auto it : current->getChildren())
+		for (auto game : current->getChildren())
 		{
-			files.push_back(it);
-			if (it->getType() == FOLDER)
-				stack.push((FolderData*)it);
+			if (game->getType() == FOLDER)
+			{
+				stack.push((FolderData*)game);
+				continue;
+			}
+
+			if (game->getType() != GAME)
+				continue;
+
+			std::shared_ptr<const std::string> json;
+
+			auto it = previousIndex.find(game);
+			if (it != previousIndex.cend() && previous->paths[it->second] == game->getPath() && game->getMetadata().getGeneration() <= previous->generation)
+			{
+				json = previous->json[it->second];
+				if (it->second != snapshot->games.size())
+					changed = true;
+			}
+			else
+			{
+				update->changes.push_back(std::make_pair(snapshot->games.size(), FileDataFields()));
+				getFileDataFields(game, GameIdIndex::getId(game), false, fields.size() ? &fields : nullptr, update->changes.back().second);
+				changed = true;
+			}
+
+			snapshot->games.push_back(game);
+			snapshot->paths.push_back(game->getPath());
+			snapshot->json.push_back(json);
 		}
 	}
 
-	for (auto game : files)
-		getFileDataJson(writer, game);
+	if (!changed && previous->games.size() == snapshot->games.size())
+	{
+		update->snapshot = previous;
+		update->isNew = false;
+		return update;
+	}
 
-	writer.EndArray();
+	update->isNew = true;
+	return update;
+}
+
+bool HttpApi::getSystemGames(Window* window, SystemData* system, const GameListQuery& query, std::string& json, std::string& etag, size_t& total)
+{
+	// Unknown keys are dropped, so that the snapshots can only be keyed by existing fields
+	std::set<std::string> knownFields = { "id", "path", "name", "systemName" };
+	for (auto mdd : MetaDataList::getMDD())
+		if (mdd.id != MetaDataId::Name)
+			knownFields.insert(getFileDataFieldKey(mdd));
+
+	std::set<std::string> fields;
+	for (auto field : Utils::String::split(query.fields, ','))
+	{
+		field = Utils::String::trim(field);
+		if (knownFields.find(field) != knownFields.cend())
+			fields.insert(field);
+	}
+
+	// Asking for every field is the same listing as asking for none
+	if (fields.size() == knownFields.size())
+		fields.clear();
+
+	std::string systemName = system->getName();
+	std::string key = systemName + "|" + Utils::String::join(std::vector<std::string>(fields.cbegin(), fields.cend()), ",");
+
+	auto promise = std::make_shared<std::promise<std::shared_ptr<GameListUpdate>>>();
+	auto future = promise->get_future();
+
+	window->postToUiThread([promise, key, systemName, fields]() { promise->set_value(updateGameListSnapshot(key, systemName, fields)); });
+
+	std::shared_ptr<GameListSnapshot> snapshot;
+	if (future.wait_for(std::chrono::seconds(5)) == std::future_status::ready)
+	{
+		auto update = future.get();
+		if (update != nullptr)
+		{
+			snapshot = update->snapshot;
+
+			if (update->isNew)
+			{
+				for (auto& change : update->changes)
+				{
+					rapidjson::StringBuffer s;
+					rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+					writeFileDataJson(writer, change.second);
+
+					snapshot->json[change.first] = std::make_shared<const std::string>(s.GetString(), s.GetSize());
+				}
+
+				snapshot->version = ++sGameListVersion;
+				publishGameListSnapshot(key, snapshot);
+			}
+		}
+	}
+	else // The UI thread doesn't answer (a game is running...) : serve the last snapshot
+		snapshot = getGameListSnapshot(key);
+
+	if (snapshot == nullptr)
+		return false;
+
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "\"%x-%x\"", sGameListEpoch, snapshot->version);
+	etag = buffer;
+
+	total = snapshot->json.size();
+
+	size_t start = std::min(query.offset, total);
+	size_t end = query.limit == 0 ? total : std::min(total, start + query.limit);
+
+	size_t length = 2;
+	for (size_t i = start; i < end; i++)
+		length += snapshot->json[i]->size() + 1;
+
+	json.clear();
+	json.reserve(length);
+	json += "[";
+
+	for (size_t i = start; i < end; i++)
+	{
+		if (i != start)
+			json += ",";
+
+		json += *snapshot->json[i];
+	}
+
+	json += "]";
+	return true;
+}
+
+struct GameImport
+{
+	GameImport() : system(nullptr), games(0), added(0), parseMs(0), applyMs(0), indexMs(0), collectionsMs(0), viewsMs(0), saveMs(0) { }
+
+	pugi::xml_document doc;
+	SystemData* system;
+
+	size_t games;
+	size_t added;
+
+	int parseMs;
+	int applyMs;
+	int indexMs;
+	int collectionsMs;
+	int viewsMs;
+	int saveMs;
+};
+
+static int lapMs(std::chrono::steady_clock::time_point& since)
+{
+	auto now = std::chrono::steady_clock::now();
+	int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count();
+	since = now;
+	return ms;
+}
+
+// Applies a parsed <gameList> to a system. For a displayed system (UI thread only), the filter index,
+// the collections and the views are updated once for the whole batch instead of once per game.
+static void applyGameImport(GameImport& import, bool displayed)
+{
+	auto clock = std::chrono::steady_clock::now();
+
+	SystemData* system = import.system;
+	pugi::xml_node root = import.doc.child("gameList");
+
+	std::unordered_map<std::string, FileData*> fileMap;
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+		fileMap[file->getPath()] = file;
+
+	// Known games leave the filter index with their old metadata, they're indexed again once updated
+	std::unordered_set<FileData*> known;
+
+	std::string relativeTo = system->getStartPath();
+	for (pugi::xml_node fileNode : root.children("game"))
+	{
+		auto it = fileMap.find(Utils::FileSystem::resolveRelativePath(fileNode.child("path").text().get(), relativeTo, false));
+		if (it == fileMap.cend() || !known.insert(it->second).second)
+			continue;
+
+		if (displayed)
+			system->removeFromIndex(it->second);
+	}
+
+	import.indexMs = lapMs(clock);
+
+	auto files = loadGamelistNodes(root, system, fileMap, SIZE_MAX, false);
+	for (auto file : files)
+		file->getMetadata().setDirty();
+
+	import.games = files.size();
+	for (auto file : files)
+		if (known.find(file) == known.cend())
+			import.added++;
+
+	import.applyMs = lapMs(clock);
+
+	if (!displayed)
+		return;
+
+	for (auto file : known)
+		system->addToIndex(file);
+
+	for (auto file : files)
+		if (file->getType() == GAME && known.find(file) == known.cend())
+			system->addToIndex(file);
+
+	import.indexMs += lapMs(clock);
+
+	CollectionSystemManager::get()->refreshCollectionSystems(files);
+	import.collectionsMs = lapMs(clock);
+
+	if (ViewController::hasInstance())
+		ViewController::get()->onFileChanged(system->getRootFolder(), FILE_METADATA_CHANGED); // Update root folder
+
+	import.viewsMs = lapMs(clock);
+}
+
+static std::string getGameImportJson(const GameImport& import, const std::string& systemName, bool pending)
+{
+	rapidjson::StringBuffer s;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+
+	writer.StartObject();
+	writer.Key("system"); writer.String(systemName.c_str());
+
+	if (pending)
+	{
+		writer.Key("pending"); writer.Bool(true);
+	}
+	else
+	{
+		writer.Key("games"); writer.Uint64(import.games);
+		writer.Key("added"); writer.Uint64(import.added);
+	}
+
+	writer.Key("timings");
+	writer.StartObject();
+	writer.Key("parse"); writer.Int(import.parseMs);
+
+	if (!pending)
+	{
+		writer.Key("apply"); writer.Int(import.applyMs);
+		writer.Key("index"); writer.Int(import.indexMs);
+		writer.Key("collections"); writer.Int(import.collectionsMs);
+		writer.Key("views"); writer.Int(import.viewsMs);
+		writer.Key("save"); writer.Int(import.saveMs);
+	}
+
+	writer.EndObject();
+	writer.EndObject();
 
 	return s.GetString();
 }
 
+int HttpApi::importGames(Window* window, const std::string& systemName, const std::string& xml, std::string& json)
+{
+	auto clock = std::chrono::steady_clock::now();
+	auto import = std::make_shared<GameImport>();
+
+	// The body is parsed here, the UI thread only applies the parsed nodes
+	pugi::xml_parse_result result = import->doc.load_string(xml.c_str());
+	if (!result || !import->doc.child("gameList"))
+	{
+		LOG(LogError) << "HttpApi::importGames : invalid gamelist " << (result ? "(no <gameList> node)" : result.description());
+		return 400;
+	}
+
+	import->parseMs = lapMs(clock);
+
+	if (SystemData::getSystem(systemName) == nullptr)
+	{
+		// Not displayed : nothing to index or to refresh, the system is only loaded to update its gamelist
+		import->system = SystemData::loadSystem(systemName, false);
+		if (import->system == nullptr)
+			return 404;
+
+		applyGameImport(*import, false);
+
+		if (import->games > 0)
+		{
+			clock = std::chrono::steady_clock::now();
+			updateGamelist(import->system);
+			import->saveMs = lapMs(clock);
+		}
+
+		delete import->system;
+		import->system = nullptr;
+
+		if (import->games == 0)
+			return 204;
+
+		window->postToUiThread([window]() { GuiMenu::updateGameLists(window, false); });
+
+		json = getGameImportJson(*import, systemName, false);
+		return 201;
+	}
+
+	auto promise = std::make_shared<std::promise<void>>();
+	auto future = promise->get_future();
+
+	window->postToUiThread([import, systemName, promise]()
+	{
+		import->system = SystemData::getSystem(systemName);
+		if (import->system != nullptr)
+		{
+			applyGameImport(*import, true);
+
+			if (import->games > 0)
+				updateGamelist(import->system, true);
+		}
+
+		promise->set_value();
+	});
+
+	if (future.wait_for(std::chrono::seconds(30)) != std::future_status::ready)
+	{
+		// The UI thread doesn't answer (a game is running...) : the import is applied when it's back
+		json = getGameImportJson(*import, systemName, true);
+		return 202;
+	}
+
+	if (import->system == nullptr)
+		return 404;
+
+	if (import->games == 0)
+		return 204;
+
+	clock = std::chrono::steady_clock::now();
+	waitForGamelistWrites();
+	import->saveMs = lapMs(clock);
+
+	LOG(LogInfo) << "HttpApi::importGames : " << import->games << " games imported into " << systemName << " (parse " << import->parseMs << "ms, apply " << import->applyMs
+		<< "ms, index " << import->indexMs << "ms, collections " << import->collectionsMs << "ms, views " << import->viewsMs << "ms, save " << import->saveMs << "ms)";
+
+	json = getGameImportJson(*import, systemName, false);
+	return 200;
+}
+
 std::string HttpApi::getRunnningGameInfo()
 {
 	auto file = FileData::GetRunningGame();
@@ -8,13 +8,29 @@
 
 class SystemData;
 class FileData;
+class Window;
+
+struct GameListQuery
+{
+	GameListQuery() : offset(0), limit(0) { }
+
+	size_t		offset;
+	size_t		limit;	// 0 = all games
+	std::string fields; // Comma separated keys to keep in each game, empty = all
+};
 
 class HttpApi
 {
 public:
 	static std::string getCaps();
 	static std::string getSystemList();
-	static std::string getSystemGames(SystemData* system);
+	// Compact JSON array of the games of a system, from a snapshot of the tree taken on the UI thread.
+	// Returns false if the UI thread is busy and the list was never built.
+	static bool getSystemGames(Window* window, SystemData* system, const GameListQuery& query, std::string& json, std::string& etag, size_t& total);
+
+	// Imports a partial gamelist.xml into a system, and returns the http status. json gets the counts & per phase timings.
+	// Displayed systems are updated on the UI thread in a single batch : filter index, collections, then one view refresh.
+	static int importGames(Window* window, const std::string& systemName, const std::string& xml, std::string& json);
 
 	static std::string getRunnningGameInfo();
 
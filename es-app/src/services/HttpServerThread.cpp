@@ -24,6 +24,10 @@
 #include "scrapers/ThreadedScraper.h"
 #include "guis/GuiUpdate.h"
 #include "ContentInstaller.h"
+#include "resources/ResourceManager.h"
+#include "utils/TimeUtil.h"
+#include <atomic>
+#include <time.h>
 
 /* 
 
@@ -45,14 +49,15 @@ System/Games APIS
 GET  /systems
 GET  /systems/{systemName}
 GET  /systems/{systemName}/logo
+GET  /systems/{systemName}/games?offset=&limit=&fields=			-> compact JSON, X-Total-Count and ETag headers
 GET  /systems/{systemName}/games/{gameId}		
 POST /systems/{systemName}/games/{gameId}						-> body must contain the game metadata to save as application/json
-GET  /systems/{systemName}/games/{gameId}/media/{mediaType}
+GET  /systems/{systemName}/games/{gameId}/media/{mediaType}		-> streamed, supports Range, If-None-Match and If-Modified-Since
 POST /systems/{systemName}/games/{gameId}/media/{mediaType}		-> body must contain the file bytes to save. Content-type must be valid.
 
 Store APIs
 ----------
-POST /addgames/{systemName}										-> body must contain partial gamelist.xml file as application/xml
+POST /addgames/{systemName}										-> body must contain partial gamelist.xml file as application/xml. Returns the counts & per phase timings as json
 POST /removegames/{systemName}									-> body must contains partial gamelist.xml file as application/xml
 
 File APIs
@@ -107,7 +112,16 @@ static std::map<std::string, std::string> mimeTypes =
 	{ "js", "application/javascript" },
 	{ "wasm", "application/wasm" },
 	{ "xml", "application/xml" },
-	{ "xhtml", "application/xhtml+xml" }
+	{ "xhtml", "application/xhtml+xml" },
+	{ "mp4", "video/mp4" },
+	{ "m4v", "video/mp4" },
+	{ "webm", "video/webm" },
+	{ "mkv", "video/x-matroska" },
+	{ "avi", "video/x-msvideo" },
+	{ "mov", "video/quicktime" },
+	{ "mp3", "audio/mpeg" },
+	{ "ogg", "audio/ogg" },
+	{ "cbz", "application/vnd.comicbook+zip" }
 };
 
 std::string HttpServerThread::getMimeType(const std::string &path)
@@ -137,6 +151,140 @@ static bool isAllowed(const httplib::Request& req, httplib::Response& res)
 	return true;
 }
 
+#define MEDIA_STREAM_CHUNK	(64 * 1024)
+#define MAX_MEDIA_STREAMS	4
+
+static std::atomic<int> sMediaStreams(0);
+
+static std::string formatHttpDate(time_t time)
+{
+	char buffer[64];
+
+	struct tm tm;
+#ifdef WIN32
+	gmtime_s(&tm, &time);
+#else
+	gmtime_r(&time, &tm);
+#endif
+
+	strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+	return buffer;
+}
+
+// Streams a file from the disk, MEDIA_STREAM_CHUNK at a time, instead of loading it in memory.
+// httplib handles Range requests (206 / multipart) from the content length, and the file is seeked to each range.
+// Files are revalidated with ETag / Last-Modified, and at most MAX_MEDIA_STREAMS files are streamed at once.
+static void serveFile(const httplib::Request& req, httplib::Response& res, const std::string& path)
+{
+	if (!Utils::FileSystem::exists(path) || Utils::FileSystem::isDirectory(path))
+	{
+		// Resources embedded in the application
+		auto data = ResourceManager::getInstance()->getFileData(path);
+		if (data.ptr)
+			res.set_content((char*)data.ptr.get(), data.length, HttpServerThread::getMimeType(path).c_str());
+		else
+		{
+			res.set_content("404 media not found", "text/html");
+			res.status = 404;
+		}
+
+		return;
+	}
+
+	auto size = Utils::FileSystem::getFileSize(path);
+	auto modified = Utils::FileSystem::getFileModificationDate(path).getTime();
+
+	char etag[64];
+	snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)size, (unsigned long long)modified);
+
+	std::string lastModified = formatHttpDate(modified);
+
+	res.set_header("ETag", etag);
+	res.set_header("Last-Modified", lastModified);
+	res.set_header("Accept-Ranges", "bytes");
+	res.set_header("Cache-Control", "no-cache");
+
+	if (req.has_header("If-None-Match"))
+	{
+		auto match = req.get_header_value("If-None-Match");
+		if (match == "*" || match.find(etag) != std::string::npos)
+		{
+			res.status = 304;
+			return;
+		}
+	}
+	else if (req.has_header("If-Modified-Since") && req.get_header_value("If-Modified-Since") == lastModified)
+	{
+		res.status = 304;
+		return;
+	}
+
+	if (size == 0)
+	{
+		res.set_content("", HttpServerThread::getMimeType(path).c_str());
+		return;
+	}
+
+	if (++sMediaStreams > MAX_MEDIA_STREAMS)
+	{
+		sMediaStreams--;
+
+		res.set_header("Retry-After", "1");
+		res.set_content("503 too many media requests", "text/html");
+		res.status = 503;
+		return;
+	}
+
+#if WIN32
+	FILE* file = _wfopen(Utils::String::convertToWideString(path).c_str(), L"rb");
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+#endif
+
+	if (file == nullptr)
+	{
+		sMediaStreams--;
+
+		res.set_content("404 media not found", "text/html");
+		res.status = 404;
+		return;
+	}
+
+	res.set_header("Content-Type", HttpServerThread::getMimeType(path));
+
+	std::shared_ptr<std::vector<char>> buffer = std::make_shared<std::vector<char>>(MEDIA_STREAM_CHUNK);
+	std::shared_ptr<size_t> position = std::make_shared<size_t>(0);
+
+	res.set_content_provider((size_t)size,
+		[file, buffer, position](size_t offset, size_t length, httplib::DataSink& sink)
+		{
+			if (*position != offset)
+			{
+#if WIN32
+				if (_fseeki64(file, (long long)offset, SEEK_SET) != 0)
+#else
+				if (fseeko(file, (off_t)offset, SEEK_SET) != 0)
+#endif
+					return false;
+
+				*position = offset;
+			}
+
+			size_t read = fread(buffer->data(), 1, std::min(length, buffer->size()), file);
+			if (read == 0)
+				return false;
+
+			*position += read;
+			sink.write(buffer->data(), read);
+			return true;
+		},
+		[file]
+		{
+			fclose(file);
+			sMediaStreams--;
+		});
+}
+
 void HttpServerThread::run()
 {
 	mHttpServer = new httplib::Server();
@@ -323,10 +471,9 @@ void HttpServerThread::run()
 				if (elem && elem->has("path"))
 				{
 					std::string logo = elem->get<std::string>("path");
-					auto data = ResourceManager::getInstance()->getFileData(logo);
-					if (data.ptr)
+					if (ResourceManager::getInstance()->fileExists(logo))
 					{
-						res.set_content((char*)data.ptr.get(), data.length, getMimeType(logo).c_str());
+						serveFile(req, res, logo);
 						return;
 					}
 				}
@@ -337,7 +484,7 @@ void HttpServerThread::run()
 		res.status = 404;
 	});
 	
-	mHttpServer->Get(R"(/systems/(/?.*)/games)", [](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Get(R"(/systems/(/?.*)/games)", [this](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
@@ -346,7 +493,36 @@ void HttpServerThread::run()
 		SystemData* system = SystemData::getSystem(systemName);
 		if (system != nullptr)
 		{
-			res.set_content(HttpApi::getSystemGames(system), "application/json");
+			GameListQuery query;
+			if (req.has_param("offset"))
+				query.offset = (size_t)std::max(0, Utils::String::toInteger(req.get_param_value("offset")));
+			if (req.has_param("limit"))
+				query.limit = (size_t)std::max(0, Utils::String::toInteger(req.get_param_value("limit")));
+			if (req.has_param("fields"))
+				query.fields = req.get_param_value("fields");
+
+			std::string json;
+			std::string etag;
+			size_t total = 0;
+
+			if (!HttpApi::getSystemGames(mWindow, system, query, json, etag, total))
+			{
+				res.set_header("Retry-After", "5");
+				res.set_content("503 game list not available", "text/html");
+				res.status = 503;
+				return;
+			}
+
+			res.set_header("ETag", etag);
+			res.set_header("X-Total-Count", std::to_string(total));
+
+			if (req.has_header("If-None-Match") && req.get_header_value("If-None-Match").find(etag) != std::string::npos)
+			{
+				res.status = 304;
+				return;
+			}
+
+			res.set_content(json, "application/json");
 			return;
 		}
 		
@@ -374,13 +550,7 @@ void HttpServerThread::run()
 					std::string path = game->getMetadata().get(metadataName);
 					if (!path.empty())
 					{
-						auto data = ResourceManager::getInstance()->getFileData(path);
-						if (data.ptr)
-						{
-							res.set_content((char*)data.ptr.get(), data.length, getMimeType(path).c_str());
-							return;
-						}
-
+						serveFile(req, res, path);
 						return;
 					}
 				}
@@ -605,66 +775,19 @@ void HttpServerThread::run()
 
 		std::string systemName = req.matches[1];
 
-		bool deleteSystem = false;
+		std::string json;
+		int status = HttpApi::importGames(mWindow, systemName, req.body, json);
 
-		SystemData* system = SystemData::getSystem(systemName);		
-		if (system == nullptr)
-		{
-			system = SystemData::loadSystem(systemName, false);
-			if (system == nullptr)
-			{
-				res.set_content("404 System not found", "text/html");
-				res.status = 404;
-				return;
-			}
-
-			deleteSystem = true;
-		}
-			
-		std::unordered_map<std::string, FileData*> fileMap;
-		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
-			fileMap[file->getPath()] = file;
-
-		auto fileList = loadGamelistFile(req.body, system, fileMap, SIZE_MAX, false);
-		if (fileList.size() == 0)
-		{
+		if (status == 400)
+			res.set_content("400 bad request - invalid gamelist", "text/html");
+		else if (status == 404)
+			res.set_content("404 System not found", "text/html");
+		else if (status == 204)
 			res.set_content("204 No game added / updated", "text/html");
-			res.status = 204;
-
-			if (deleteSystem)
-				delete system;
-
-			return;
-		}
-	
-		for (auto file : fileList)
-			file->getMetadata().setDirty();
-
-		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
-			if (fileMap.find(file->getPath()) != fileMap.cend())
-				file->getMetadata().setDirty();
-
-		updateGamelist(system);
-
-		if (deleteSystem)
-		{		
-			delete system;
-
-			res.set_content("201 Game added. System not updated", "text/html");
-			res.status = 201;
-
-			Window* w = mWindow;
-			mWindow->postToUiThread([w]() { GuiMenu::updateGameLists(w, false); });
-		}
-		else if (ViewController::hasInstance())
-		{
-			mWindow->postToUiThread([system]()
-			{
-				ViewController::get()->onFileChanged(system->getRootFolder(), FILE_METADATA_CHANGED); // Update root folder			
-			});
-		}
+		else
+			res.set_content(json, "application/json");
 
-		res.set_content("OK", "text/html");
+		res.status = status;
 	});
 	
 	mHttpServer->Post(R"(/removegames/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
@@ -706,8 +829,6 @@ void HttpServerThread::run()
 
 		for (auto file : fileList)
 		{
-			removeFromGamelistRecovery(file);
-
 			auto filePath = file->getPath();
 			if (Utils::FileSystem::exists(filePath))
 				Utils::FileSystem::removeFile(filePath);
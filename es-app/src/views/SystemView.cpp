@@ -129,15 +129,7 @@ void SystemView::reloadTheme(SystemData* system)
 void SystemView::loadExtras(SystemData* system)
 {
 	auto it = std::find_if(mEntries.begin(), mEntries.end(), [system](const SystemViewData& ss) { return ss.object == system; });
-	if (it != mEntries.cend())
-	{
-		// delete any existing extras
-		for (auto extra : it->backgroundExtras)
-			delete extra;
 
-		it->backgroundExtras.clear();
-	}
-	
 	size_t vram = Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
 	size_t size = TextureResource::getTotalMemUsage();
 
@@ -202,12 +194,44 @@ void SystemView::loadExtras(SystemData* system)
 		mEntries.push_back(data);
 	}
 	else
+	{
+		// Existing extras are deleted once the new ones are built, so the textures they share are not unloaded & loaded again
+		auto oldExtras = it->backgroundExtras;
 		it->backgroundExtras = extras;
 
+		for (auto extra : oldExtras)
+			delete extra;
+	}
+
+	for (auto extra : extras)
+	{
+		if (mDisable)
+			extra->topWindow(false);
+
+		if (mScreensaverActive)
+			extra->onScreenSaverActivate();
+	}
+
 	SystemRandomPlaylist::resetCache();
 }
 
 
+void SystemView::logScrollFrameTimes()
+{
+	// Frame times while the carousel was scrolling : spikes show extras whose textures were not decoded in time
+	if (mScrollFrameTimes.size() >= 30)
+	{
+		std::sort(mScrollFrameTimes.begin(), mScrollFrameTimes.end());
+
+		auto percentile = [this](int p) { return mScrollFrameTimes[(mScrollFrameTimes.size() - 1) * p / 100]; };
+
+		LOG(LogDebug) << "SystemView : " << mScrollFrameTimes.size() << " frames while scrolling, p50 " << percentile(50) << "ms, p95 " << percentile(95)
+			<< "ms, p99 " << percentile(99) << "ms, max " << mScrollFrameTimes.back() << "ms";
+	}
+
+	mScrollFrameTimes.clear();
+}
+
 void SystemView::populate()
 {
 	TextureLoader::paused = true;
@@ -627,6 +651,11 @@ void SystemView::update(int deltaTime)
 		for (auto extra : entry.backgroundExtras)
 			extra->update(deltaTime);
 
+	if (mCarousel.getScrollingVelocity() != 0 && mScrollFrameTimes.size() < 10000)
+		mScrollFrameTimes.push_back(deltaTime);
+	else if (mScrollFrameTimes.size())
+		logScrollFrameTimes();
+
 	GuiComponent::update(deltaTime);
 
 	if (mYButton.isLongPressed(deltaTime))
@@ -1118,7 +1147,7 @@ void SystemView::ensureTexture(GuiComponent* extra, bool reload)
 		{
 			auto tex = image->getTexture();
 			if (tex == nullptr)
-				return;
+				continue;
 
 			if (reload)
 				tex->reload();
@@ -1154,7 +1183,7 @@ void SystemView::preloadExtraNeighbours(int cursor)
 		auto carousel = mCarousel.asCarousel();
 		if (carousel)
 		{
-			auto logo = carousel->getLogo(dx);
+			auto logo = carousel->getLogo(index);
 			if (logo)
 				ensureTexture(logo.get(), dx > 1);
 		}
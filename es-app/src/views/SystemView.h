@@ -87,6 +87,7 @@ private:
 	void	 activateExtras(int cursor, bool activate = true);	
 	void	 updateExtras(const std::function<void(GuiComponent*)>& func);
 	void	 clearEntries();
+	void	 logScrollFrameTimes();
 
 	int		 moveCursorFast(bool forward = true);
 
@@ -110,6 +111,8 @@ private:
 	std::vector<GuiComponent*>			mStaticBackgrounds;
 	std::vector<SystemViewData>			mEntries;
 
+	std::vector<int>					mScrollFrameTimes;
+
 	float			mCamOffset;
 	float			mExtrasCamOffset;
 	float			mExtrasFadeOpacity;
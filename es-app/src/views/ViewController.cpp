@@ -1126,6 +1126,7 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 		Renderer::resetCache();
 
 	Utils::FileSystem::FileSystemCacheActivator fsc;
+	ThemeData::DocumentCacheActivator tdc;
 
 	if (mCurrentView != nullptr)
 	{
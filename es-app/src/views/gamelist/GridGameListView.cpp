@@ -12,6 +12,7 @@
 #include "guis/GuiGamelistOptions.h"
 #include "GameNameFormatter.h"
 #include "utils/Randomizer.h"
+#include "ImageIO.h"
 
 GridGameListView::GridGameListView(Window* window, FolderData* root, const std::shared_ptr<ThemeData>& theme, std::string themeName, Vector2f gridSize) :
 	ISimpleGameListView(window, root),
@@ -190,8 +191,21 @@ void GridGameListView::populateList(const std::vector<FileData*>& files)
 
 		GameNameFormatter formatter(mRoot->getSystem());
 
+		std::vector<std::string> imagePaths;
+		imagePaths.reserve(files.size());
+
 		for (auto file : files)
-			mGrid.add(formatter.getDisplayName(file, file->getType() == FOLDER && Utils::FileSystem::exists(getImagePath(file))), getImagePath(file), file);
+			imagePaths.push_back(getImagePath(file));
+
+		// Tiles need the image sizes to be laid out : probe them in the background. A tile that is laid out first reads its own size, as before
+		if (Settings::getInstance()->getBool("AsyncImages"))
+			ImageIO::loadImageSizes(imagePaths);
+
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			auto file = files[i];
+			mGrid.add(formatter.getDisplayName(file, file->getType() == FOLDER && Utils::FileSystem::exists(imagePaths[i])), imagePaths[i], file);
+		}
 
 		// if we have the ".." PLACEHOLDER, then select the first game instead of the placeholder
 		if (showParentFolder && mCursorStack.size() && mGrid.size() > 1 && mGrid.getCursorIndex() == 0)
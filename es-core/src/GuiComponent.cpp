@@ -1124,109 +1124,137 @@ ThemeData::ThemeElement::Property GuiComponent::getProperty(const std::string na
 	return unk;
 }
 
-void GuiComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+static bool isScrollableContainerProperty(const std::string& name)
 {
-	Vector2f screenScale = Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
-	Vector4f clientRectangle = getParent() ? getParent()->getClientRect() : Vector4f(0, 0, (float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
-	Vector2f scale = Vector2f(clientRectangle.z(), clientRectangle.w());
-	Vector2f offset = Vector2f(clientRectangle.x(), clientRectangle.y());
+	return name == "pos" || name == "x" || name == "y" || name == "size" || name == "w" || name == "h" || name == "offset" || name == "offsetX" || name == "offsetY";
+}
 
-	if (getParent() != nullptr && getParent()->isKindOf<ScrollableContainer>())
-	{
-		if (name == "pos" || name == "x" || name == "y" || name == "size" || name == "w" || name == "h" || name == "offset" || name == "offsetX" || name == "offsetY")
-		{
-			getParent()->setProperty(name, value);
-			return;
-		}
-	}
+Vector4f GuiComponent::getParentClientRect()
+{
+	return getParent() ? getParent()->getClientRect() : Vector4f(0, 0, (float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
+}
+
+const std::unordered_map<std::string, GuiComponent::PropertySetter>& GuiComponent::getBasePropertySetters()
+{
+	typedef ThemeData::ThemeElement::Property Property;
 
-	switch (value.type)
+	static std::unordered_map<std::string, PropertySetter> setters =
 	{
-	case ThemeData::ThemeElement::Property::PropertyType::Pair:
+		{ "pos", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Pair) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.xy() = value.v;
+				c->setPosition(Vector3f(rc.x() + value.v.x() * rc.z(), rc.y() + value.v.y() * rc.w(), 0));
+			} },
+		{ "size", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Pair) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.zw() = value.v;
+				c->setSize(Vector2f(value.v.x() * rc.z(), value.v.y() * rc.w()));
+			} },
+		{ "origin", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Pair) c->setOrigin(value.v); } },
+		{ "rotationOrigin", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Pair) c->setRotationOrigin(value.v); } },
+		{ "scaleOrigin", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Pair) c->setScaleOrigin(value.v); } },
+		{ "offset", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type == Property::PropertyType::Pair)
+					c->setScreenOffset(Vector2f(value.v.x() * (float)Renderer::getScreenWidth(), value.v.y() * (float)Renderer::getScreenHeight()));
+			} },
+		{ "x", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Float) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.x() = value.f;
+				c->setPosition(Vector3f(rc.x() + value.f * rc.z(), c->mPosition.y(), 0));
+			} },
+		{ "y", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Float) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.y() = value.f;
+				c->setPosition(Vector3f(c->mPosition.x(), rc.y() + value.f * rc.w(), 0));
+			} },
+		{ "w", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Float) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.z() = value.f;
+				c->setSize(Vector2f(value.f * rc.z(), c->mSize.y()));
+			} },
+		{ "h", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Float) return;
+				Vector4f rc = c->getParentClientRect();
+				c->mSourceBounds.w() = value.f;
+				c->setSize(Vector2f(c->mSize.x(), value.f * rc.w()));
+			} },
+		{ "rotation", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Float) c->setRotationDegrees(value.f); } },
+		{ "zIndex", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Float) c->setZIndex(value.f); } },
+		{ "opacity", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Float) c->setOpacity(value.f * 255.0f); } },
+		{ "scale", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Float) c->setScale(value.f); } },
+		{ "offsetX", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type == Property::PropertyType::Float)
+					c->setScreenOffset(Vector2f(value.f * (float)Renderer::getScreenWidth(), c->mScreenOffset.y()));
+			} },
+		{ "offsetY", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type == Property::PropertyType::Float)
+					c->setScreenOffset(Vector2f(c->mScreenOffset.x(), value.f * (float)Renderer::getScreenHeight()));
+			} },
+		{ "clipRect", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::Rect) return;
+				Vector2f screenScale = Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
+				c->setClipRect(Vector4f(value.r.x() * screenScale.x(), value.r.y() * screenScale.y(), value.r.z() * screenScale.x(), value.r.w() * screenScale.y()));
+			} },
+		{ "padding", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Rect) c->setPadding(value.r); } },
+		{ "visible", [](GuiComponent* c, const Property& value) { if (value.type == Property::PropertyType::Bool) c->setVisible(value.b); } },
+		{ "sound", [](GuiComponent* c, const Property& value)
+			{
+				if (value.type != Property::PropertyType::String || c->mStoryBoardSound == value.s)
+					return;
 
-		if (name == "pos")
-		{
-			mSourceBounds.xy() = value.v;
-			setPosition(Vector3f(offset.x() + value.v.x() * scale.x(), offset.y() + value.v.y() * scale.y(), 0));
-		}
-		else if (name == "size")
-		{
-			mSourceBounds.zw() = value.v;
-			setSize(Vector2f(value.v.x() * scale.x(), value.v.y() * scale.y()));
-		}
-		else if (name == "origin")
-			setOrigin(Vector2f(value.v.x(), value.v.y()));
-		else if (name == "rotationOrigin")
-			setRotationOrigin(Vector2f(value.v.x(), value.v.y()));
-		else if (name == "scaleOrigin")
-			setScaleOrigin(Vector2f(value.v.x(), value.v.y()));
-		else if (name == "offset")
-			setScreenOffset(Vector2f(value.v.x() * screenScale.x(), value.v.y() * screenScale.y()));
+				c->mStoryBoardSound = value.s;
 
-		break;
+				if (!c->mStoryBoardSound.empty())
+					Sound::get(c->mStoryBoardSound)->play();
+			} },
+	};
 
-	case ThemeData::ThemeElement::Property::PropertyType::Float:
+	return setters;
+}
 
-		if (name == "x")
-		{
-			mSourceBounds.x() = value.f;
-			setPosition(Vector3f(offset.x() + value.f * scale.x(), mPosition.y(), 0));
-		}
-		else if (name == "y")
-		{
-			mSourceBounds.y() = value.f;
-			setPosition(Vector3f(mPosition.x(), offset.y() + value.f * scale.y(), 0));
-		}
-		else if (name == "w")
-		{
-			mSourceBounds.z() = value.f;
-			setSize(Vector2f(value.f * scale.x(), mSize.y()));
-		}
-		else if (name == "h")
-		{
-			mSourceBounds.w() = value.f;
-			setSize(Vector2f(mSize.x(), value.f * scale.y()));
-		}
-		else if (name == "rotation")
-			setRotationDegrees(value.f);
-		else if (name == "zIndex")
-			setZIndex(value.f);
-		else if (name == "opacity")
-			setOpacity(value.f * 255.0f);
-		else if (name == "scale")
-			setScale(value.f);
-		else if (name == "offsetX")
-			setScreenOffset(Vector2f(value.f * screenScale.x(), mScreenOffset.y()));
-		else if (name == "offsetY")
-			setScreenOffset(Vector2f(mScreenOffset.x(), value.f * screenScale.y()));
-
-		break;
-
-	case ThemeData::ThemeElement::Property::PropertyType::Rect:
-		if (name == "clipRect")
-			setClipRect(Vector4f(value.r.x() * screenScale.x(), value.r.y() * screenScale.y(), value.r.z() * screenScale.x(), value.r.w() * screenScale.y()));
-		else if (name == "padding")
-			setPadding(value.r);
-
-		break;
-
-	case ThemeData::ThemeElement::Property::PropertyType::Bool:
-		if (name == "visible")
-			setVisible(value.b);
-
-		break;
-
-	case ThemeData::ThemeElement::Property::PropertyType::String:
-		if (name == "sound" && mStoryBoardSound != value.s)
-		{
-			mStoryBoardSound = value.s;
+GuiComponent::PropertySetter GuiComponent::getPropertySetter(const std::string& name)
+{
+	// Let setProperty forward these to the container
+	if (getParent() != nullptr && getParent()->isKindOf<ScrollableContainer>() && isScrollableContainerProperty(name))
+		return nullptr;
 
-			if (!mStoryBoardSound.empty())
-				Sound::get(mStoryBoardSound)->play();
-		}
+	auto& setters = getBasePropertySetters();
+
+	auto it = setters.find(name);
+	if (it != setters.cend())
+		return it->second;
+
+	return nullptr;
+}
 
-		break;
+void GuiComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+{
+	if (getParent() != nullptr && getParent()->isKindOf<ScrollableContainer>() && isScrollableContainerProperty(name))
+	{
+		getParent()->setProperty(name, value);
+		return;
 	}
+
+	auto& setters = getBasePropertySetters();
+
+	auto it = setters.find(name);
+	if (it != setters.cend())
+		it->second(this, value);
 	
 	mTransformDirty = true;
 }
@@ -10,6 +10,7 @@
 #include <functional>
 #include "ThemeData.h"
 #include <memory>
+#include <unordered_map>
 #include "anim/ThemeStoryboard.h"
 
 class Animation;
@@ -148,6 +149,12 @@ public:
 	virtual ThemeData::ThemeElement::Property getProperty(const std::string name);
 	virtual void	setProperty(const std::string name, const ThemeData::ThemeElement::Property& value);
 
+	// Typed handle to a property, resolved once so animations don't have to dispatch on the property name every frame.
+	// Returns nullptr if the property has to go through setProperty ( component specific properties ).
+	typedef void(*PropertySetter)(GuiComponent* component, const ThemeData::ThemeElement::Property& value);
+	virtual PropertySetter getPropertySetter(const std::string& name);
+	inline void		applyProperty(PropertySetter setter, const ThemeData::ThemeElement::Property& value) { setter(this, value); mTransformDirty = true; }
+
 	bool&			isShowing() { return mShowing; }
 
 	// AnimateTo methods
@@ -278,6 +285,9 @@ public:
 	static bool isLaunchTransitionRunning;
 
 private:
+	static const std::unordered_map<std::string, PropertySetter>& getBasePropertySetters();
+	Vector4f		getParentClientRect();
+
 	std::string		mTag;
 	std::string		mClickAction;
 	bool			mMousePressed;
@@ -5,11 +5,13 @@
 #include <string.h>
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/TaskScheduler.h"
 #include <sstream>
 #include <fstream>
 #include <map>
 #include <unordered_map>
 #include <mutex>
+#include <algorithm>
 #include "renderers/Renderer.h"
 #include "Paths.h"
 #include "math/Vector4f.h"
@@ -613,6 +615,7 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 	unsigned char buf[BUFSIZE];
 	if (fread(buf, 1, BUFSIZE, f) != BUFSIZE)
 	{
+		fclose(f);
 		updateImageCache(fn, -1, -1, -1);
 		return false;
 	}
@@ -620,6 +623,8 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 	// WebP file
 	if (buf[0] == 'R' && buf[1] == 'I' && buf[2] == 'F' && buf[3] == 'F' && buf[12] == 'V' && buf[13] == 'P' && buf[14] == '8')
 	{
+		fclose(f);
+
 		switch (buf[15])
 		{
 		case ' ':			
@@ -724,6 +729,43 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 	return false;
 }
 
+void ImageIO::loadImageSizes(const std::vector<std::string>& files)
+{
+	auto pending = std::make_shared<std::vector<std::string>>();
+
+	{
+		std::unique_lock<std::mutex> lock(sizeCacheLock);
+
+		for (auto& file : files)
+			if (!file.empty() && file[0] != ':' && sizeCache.find(file) == sizeCache.cend())
+				pending->push_back(file);
+	}
+
+	if (pending->size() == 0)
+		return;
+
+	std::sort(pending->begin(), pending->end());
+	pending->erase(std::unique(pending->begin(), pending->end()), pending->end());
+
+#define SIZES_PER_TASK 32
+
+	for (size_t start = 0; start < pending->size(); start += SIZES_PER_TASK)
+	{
+		size_t end = std::min(start + SIZES_PER_TASK, pending->size());
+
+		Utils::TaskScheduler::run([pending, start, end]
+		{
+			// Not worth delaying the exit for
+			if (Utils::TaskScheduler::isStopped())
+				return;
+
+			unsigned int x, y;
+			for (size_t i = start; i < end; i++)
+				loadImageSize((*pending)[i], &x, &y);
+		}, Utils::TaskScheduler::BACKGROUND);
+	}
+}
+
 bool ImageIO::getMultiBitmapInformation(const std::string& path, int& totalFrames, int& frameTime)
 {	
 	totalFrames = 1;
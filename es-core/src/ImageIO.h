@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 #include <vector>
+#include <string>
 #include "math/Vector2f.h"
 #include "math/Vector2i.h"
 
@@ -51,6 +52,9 @@ public:
 
 	static bool		loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y);
 
+	// Probes the headers of many images on the scheduler's workers to fill the size cache, without waiting for them
+	static void		loadImageSizes(const std::vector<std::string>& files);
+
 	static void		removeImageCache(const std::string& fn);
 	static void		updateImageCache(const std::string& fn, int sz, int x, int y);
 	static void		loadImageCache();
@@ -1,5 +1,6 @@
 #include "Scripting.h"
 #include "Log.h"
+#include "Settings.h"
 #include "utils/Platform.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
@@ -8,84 +9,202 @@
 #include <thread>
 #include <set>
 #include <map>
+#include <list>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#if WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <signal.h>
+#include <pthread.h>
+#endif
 
 using namespace Utils::Platform;
 
 namespace Scripting
 {
-#if WIN32
-    static std::thread*                 mScriptQueueThread = nullptr;
-    static std::list<std::string>       mScriptQueue;
-    static std::mutex			        mScriptQueueLock;
-    static std::condition_variable		mScriptQueueEvent;
-    static bool                         mExitScriptQueue = false;
+    static std::set<std::string> _asyncEvents = { "game-start", "game-end", "game-selected", "system-selected", "screensaver-start", "screensaver-stop", "sleep", "wake" };
+
+    // Events fired on every cursor move : only the last one within DEBOUNCE_DELAY ms is delivered
+    static std::set<std::string> _debouncedEvents = { "game-selected", "system-selected" };
+
+    #define DEBOUNCE_DELAY 150
+
+    static inline bool isAsyncEvent(const std::string& eventName) { return _asyncEvents.find(eventName) != _asyncEvents.cend(); }
+
+    static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
 
-    static void executeCommandsThread()
+    // -------------------------------------------------------------------------------------------------
+    // Script folders cache. Listings are refreshed when inotify reports a change, or every few seconds without inotify.
+
+    #define SCRIPTS_CACHE_TTL 5000
+
+    struct ScriptFile
     {
-        while (true)
+        std::string path;
+        bool withEventName; // Single scripts are called with the event name as 1st arg
+    };
+
+    static std::map<std::string, std::vector<ScriptFile>> mScriptsCache;
+    static std::mutex                                     mScriptsCacheLock;
+    static std::chrono::steady_clock::time_point          mScriptsCacheTime;
+
+    static std::vector<std::string> getScriptFolders()
+    {
+        std::vector<std::string> paths =
         {
-            // Wait for an event to say there is something in the queue
-            std::unique_lock<std::mutex> lock(mScriptQueueLock);
-            mScriptQueueEvent.wait(lock, []() { return mExitScriptQueue || !mScriptQueue.empty(); });
+            Paths::getUserEmulationStationPath() + "/scripts",
+            Paths::getEmulationStationPath() + "/scripts",
+#ifndef WIN32
+            "/var/run/emulationstation/scripts"
+#endif
+        };
 
-            if (mExitScriptQueue)
-                break;
+        return VectorHelper::distinct(paths, [](auto x) { return x; });
+    }
 
-            if (!mScriptQueue.empty())
+    static std::vector<ScriptFile> listScripts(const std::string& eventName)
+    {
+        std::vector<ScriptFile> ret;
+
+        auto folders = getScriptFolders();
+
+        // Process splitted paths scripts
+        for (auto folder : folders)
+        {
+            for (auto script : Utils::FileSystem::getDirContent(folder + "/" + eventName))
             {
-                auto command = mScriptQueue.front();
-                mScriptQueue.pop_front();
+#if WIN32
+                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
+                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                    continue;
+#endif
+                ScriptFile file;
+                file.path = script;
+                file.withEventName = false;
+                ret.push_back(file);
+            }
+        }
 
-                lock.unlock();
-                std::this_thread::yield();
+        // Process single scripts. This type of scripts are called with the event name as 1st arg
+        for (auto folder : folders)
+        {
+            if (!Utils::FileSystem::exists(folder))
+                continue;
 
-                ProcessStartInfo psi;
-                psi.command = command;
-                psi.waitForExit = false;
-                psi.showWindow = false;
-                psi.run();
+            for (auto script : Utils::FileSystem::getDirectoryFiles(folder))
+            {
+                if (script.directory)
+                    continue;
 
-                LOG(LogDebug) << "  executing: " << command;
+                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
+                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                    continue;
 
-                std::this_thread::yield();
+                ScriptFile file;
+                file.path = script.path;
+                file.withEventName = true;
+                ret.push_back(file);
             }
         }
+
+        return ret;
     }
 
-    static std::string _lastCommand;
+#if defined(__linux__)
+    static int mInotify = -1;
 
-    static void pushCommand(const std::string& command)
+    static void watchScriptFolders()
     {
-        std::unique_lock<std::mutex> lock(mScriptQueueLock);
-
-        if (command == _lastCommand)
+        mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mInotify < 0)
             return;
 
-        _lastCommand = command;
+        const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+
+        for (auto folder : getScriptFolders())
+        {
+            if (!Utils::FileSystem::isDirectory(folder))
+            {
+                // Wait for the folder to be created
+                auto parent = Utils::FileSystem::getParent(folder);
+                if (Utils::FileSystem::isDirectory(parent))
+                    inotify_add_watch(mInotify, parent.c_str(), IN_CREATE | IN_MOVED_TO);
+
+                continue;
+            }
+
+            inotify_add_watch(mInotify, folder.c_str(), mask);
+
+            for (auto file : Utils::FileSystem::getDirectoryFiles(folder))
+                if (file.directory)
+                    inotify_add_watch(mInotify, file.path.c_str(), mask);
+        }
+    }
+
+    static bool scriptFoldersChanged()
+    {
+        bool changed = false;
 
-        if (mScriptQueueThread == nullptr)
-            mScriptQueueThread = new std::thread(&executeCommandsThread);
+        char buffer[4096];
+        while (read(mInotify, buffer, sizeof(buffer)) > 0)
+            changed = true;
 
-        mScriptQueue.push_back(command);
-        mScriptQueueEvent.notify_one();
+        return changed;
     }
 #endif
 
-    void exitScriptingEngine()
+    static std::vector<ScriptFile> getScripts(const std::string& eventName)
     {
-#if WIN32
-        std::unique_lock<std::mutex> lock(mScriptQueueLock);
-        mExitScriptQueue = true;
-        mScriptQueueEvent.notify_one();
+        std::unique_lock<std::mutex> lock(mScriptsCacheLock);
+
+#if defined(__linux__)
+        if (mInotify < 0)
+        {
+            mScriptsCache.clear();
+            watchScriptFolders();
+        }
+        else if (scriptFoldersChanged())
+        {
+            // Watch again : new event folders may have been created
+            close(mInotify);
+
+            mScriptsCache.clear();
+            watchScriptFolders();
+        }
+
+        if (mInotify < 0)
+            return listScripts(eventName);
+#else
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - mScriptsCacheTime).count() > SCRIPTS_CACHE_TTL)
+        {
+            mScriptsCache.clear();
+            mScriptsCacheTime = now;
+        }
 #endif
-    }
 
-    static std::set<std::string> _asyncEvents = { "game-start", "game-end", "game-selected", "system-selected", "screensaver-start", "screensaver-stop", "sleep", "wake" };
+        auto it = mScriptsCache.find(eventName);
+        if (it != mScriptsCache.cend())
+            return it->second;
 
-    static inline bool isAsyncEvent(const std::string& eventName) { return _asyncEvents.find(eventName) != _asyncEvents.cend(); }
+        auto scripts = listScripts(eventName);
+        mScriptsCache[eventName] = scripts;
+        return scripts;
+    }
+
+    // -------------------------------------------------------------------------------------------------
+    // Execution
 
-    static void executeScript(const std::string& script, const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, bool allowAsync = true)
+    static void executeScript(const std::string& script, const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, bool waitForExit)
     {
         std::string command = script;
 
@@ -103,94 +222,260 @@ namespace Scripting
 #if WIN32
         if (Utils::FileSystem::getExtension(script) == ".ps1")
             command = "powershell " + command;
+#endif
 
-        if (allowAsync)
-        {            
-            LOG(LogDebug) << "  queuing: " << command;
-
-            // Start using a thread to avoid lags
-            pushCommand(command);
-        }
-        else
-        {
-            LOG(LogDebug) << "  executing: " << command;
-
-            ProcessStartInfo psi;
-            psi.command = command;
-            psi.waitForExit = true;
-            psi.showWindow = false;
-            psi.run();
-        }       
-#else            
-        LOG(LogDebug) << "  executing: " << script;
+        LOG(LogDebug) << "  executing: " << command;
 
         ProcessStartInfo psi;
         psi.command = command;
-        psi.waitForExit = (eventName == "quit");
+        psi.waitForExit = waitForExit;
         psi.showWindow = false;
+#if !WIN32
         // Don't clobber game logs when running scripts
         psi.stderrFilename = "es_script_stderr.log";
         psi.stdoutFilename = "es_script_stdout.log";
-        psi.run();
 #endif
+        psi.run();
     }
 
-    static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
-
-    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    struct ScriptEvent
     {
-        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+        std::string name;
+        std::string arg1;
+        std::string arg2;
+        std::string arg3;
 
-        // Process splitted paths scripts
-        std::vector<std::string> scriptDirList =
+        std::chrono::steady_clock::time_point dueTime;
+    };
+
+    // Optional long-lived process receiving the async events on its standard input, one per line :
+    // event name and arguments separated by tabs. When set, it replaces the scripts for these events.
+    static FILE*       mScriptHost = nullptr;
+    static std::string mScriptHostCommand;
+
+    static bool writeToScriptHost(const std::string& line)
+    {
+#if WIN32
+        return fputs(line.c_str(), mScriptHost) >= 0 && fflush(mScriptHost) == 0;
+#else
+        // Writing to a dead host raises SIGPIPE : block it on this thread during the write, and discard it
+        sigset_t pipeSet, oldSet;
+        sigemptyset(&pipeSet);
+        sigaddset(&pipeSet, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+        bool ret = fputs(line.c_str(), mScriptHost) >= 0 && fflush(mScriptHost) == 0;
+
+        sigset_t pending;
+        if (!ret && sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE))
         {
-            Paths::getUserEmulationStationPath() + "/scripts/" + eventName,
-            Paths::getEmulationStationPath() + "/scripts/" + eventName,
-#ifndef WIN32
-            "/var/run/emulationstation/scripts/" + eventName
+            int sig;
+            sigwait(&pipeSet, &sig);
+        }
+
+        pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+        return ret;
 #endif
-        };
+    }
+
+    static void closeScriptHost()
+    {
+        if (mScriptHost == nullptr)
+            return;
 
-        for (auto dir : VectorHelper::distinct(scriptDirList, [](auto x) { return x; }))
+        pclose(mScriptHost);
+        mScriptHost = nullptr;
+        mScriptHostCommand.clear();
+    }
+
+    static bool sendToScriptHost(const ScriptEvent& evt)
+    {
+        std::string host = Settings::ScriptHost();
+        if (host != mScriptHostCommand)
+            closeScriptHost();
+
+        if (host.empty())
+            return false;
+
+        if (mScriptHost == nullptr)
         {
-            auto scripts = Utils::FileSystem::getDirContent(dir);
-            for (auto script : scripts)
+            LOG(LogInfo) << "Scripting : starting script host " << host;
+
+            mScriptHost = popen(host.c_str(), "w");
+            if (mScriptHost == nullptr)
             {
-#if WIN32
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
-                    continue;
-#endif
-                executeScript(script, "", arg1, arg2, arg3, isAsyncEvent(eventName));
+                LOG(LogError) << "Scripting : unable to start script host " << host;
+                return false;
             }
+
+            mScriptHostCommand = host;
         }
 
-        // Process single scripts. This type of scripts are called with the event name as 1st arg
-        std::vector<std::string> paths =
+        std::string line = evt.name;
+        for (auto arg : { evt.arg1, evt.arg2, evt.arg3 })
+            line += "\t" + Utils::String::replace(Utils::String::replace(arg, "\t", " "), "\n", " ");
+
+        line += "\n";
+
+        if (!writeToScriptHost(line))
         {
-            Paths::getUserEmulationStationPath() + "/scripts",
-            Paths::getEmulationStationPath() + "/scripts",
-#ifndef WIN32
-            "/var/run/emulationstation/scripts"
-#endif
-        };
+            LOG(LogError) << "Scripting : script host " << host << " is not responding";
+            closeScriptHost();
+            return false;
+        }
+
+        return true;
+    }
 
-        for (auto dir : VectorHelper::distinct(paths, [](auto x) { return x; }))
+    static std::thread*               mEventQueueThread = nullptr;
+    static std::list<ScriptEvent>     mEventQueue;
+    static std::mutex                 mEventQueueLock;
+    static std::condition_variable    mEventQueueEvent;
+    static bool                       mExitEventQueue = false;
+
+    static void deliverEvent(const ScriptEvent& evt)
+    {
+        if (sendToScriptHost(evt))
+            return;
+
+        for (auto script : getScripts(evt.name))
+            executeScript(script.path, script.withEventName ? evt.name : "", evt.arg1, evt.arg2, evt.arg3, false);
+    }
+
+    static void eventQueueThread()
+    {
+        std::unique_lock<std::mutex> lock(mEventQueueLock);
+
+        while (true)
         {
-            if (!Utils::FileSystem::exists(dir))
+            if (mEventQueue.empty())
+            {
+                if (mExitEventQueue)
+                    break;
+
+                mEventQueueEvent.wait(lock, []() { return mExitEventQueue || !mEventQueue.empty(); });
                 continue;
+            }
 
-            for (auto script : Utils::FileSystem::getDirectoryFiles(dir))
+            // When exiting, pending events are delivered without waiting for their debounce delay
+            auto dueTime = mEventQueue.front().dueTime;
+            if (!mExitEventQueue && std::chrono::steady_clock::now() < dueTime)
             {
-                if (script.directory)
-                    continue;
+                // Wait for the debounce delay, or a newer event
+                mEventQueueEvent.wait_until(lock, dueTime);
+                continue;
+            }
 
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
-                    continue;
+            ScriptEvent evt = mEventQueue.front();
+            mEventQueue.pop_front();
+
+            lock.unlock();
+            deliverEvent(evt);
+            lock.lock();
+        }
 
-                executeScript(script.path, eventName, arg1, arg2, arg3, isAsyncEvent(eventName));
+        closeScriptHost();
+    }
+
+    static void queueEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+        std::unique_lock<std::mutex> lock(mEventQueueLock);
+
+        if (mExitEventQueue && mEventQueueThread == nullptr)
+        {
+            // The dispatcher is gone : run the scripts inline
+            lock.unlock();
+
+            for (auto script : getScripts(eventName))
+                executeScript(script.path, script.withEventName ? eventName : "", arg1, arg2, arg3, false);
+
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        ScriptEvent evt;
+        evt.name = eventName;
+        evt.arg1 = arg1;
+        evt.arg2 = arg2;
+        evt.arg3 = arg3;
+        evt.dueTime = now;
+
+        if (_debouncedEvents.find(eventName) != _debouncedEvents.cend())
+        {
+            // Coalesce : the pending one is obsolete
+            for (auto it = mEventQueue.begin(); it != mEventQueue.end(); )
+            {
+                if (it->name == eventName)
+                    it = mEventQueue.erase(it);
+                else
+                    it++;
             }
+
+            evt.dueTime = now + std::chrono::milliseconds(DEBOUNCE_DELAY);
+        }
+        else
+        {
+            // Deliver pending selections first, so events keep their order
+            for (auto& pending : mEventQueue)
+                if (pending.dueTime > now)
+                    pending.dueTime = now;
         }
+
+        mEventQueue.push_back(evt);
+
+        if (mEventQueueThread == nullptr)
+            mEventQueueThread = new std::thread(&eventQueueThread);
+
+        mEventQueueEvent.notify_one();
+    }
+
+    void exitScriptingEngine()
+    {
+        {
+            // The dispatcher delivers the pending events before it exits
+            std::unique_lock<std::mutex> lock(mEventQueueLock);
+            mExitEventQueue = true;
+        }
+
+        mEventQueueEvent.notify_one();
+
+        if (mEventQueueThread != nullptr)
+        {
+            mEventQueueThread->join();
+
+            std::unique_lock<std::mutex> lock(mEventQueueLock);
+            delete mEventQueueThread;
+            mEventQueueThread = nullptr;
+        }
+
+#if defined(__linux__)
+        std::unique_lock<std::mutex> lock(mScriptsCacheLock);
+        if (mInotify >= 0)
+        {
+            close(mInotify);
+            mInotify = -1;
+        }
+#endif
+    }
+
+    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+
+        if (isAsyncEvent(eventName))
+        {
+            queueEvent(eventName, arg1, arg2, arg3);
+            return;
+        }
+
+#if WIN32
+        bool waitForExit = true;
+#else
+        bool waitForExit = (eventName == "quit");
+#endif
+
+        for (auto script : getScripts(eventName))
+            executeScript(script.path, script.withEventName ? eventName : "", arg1, arg2, arg3, waitForExit);
     }
 } // Scripting::
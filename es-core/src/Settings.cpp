@@ -177,6 +177,8 @@ void Settings::setDefaults()
 	mBoolMap["QuickSystemSelect"] = true;
 	mBoolMap["MoveCarousel"] = true;
 	mBoolMap["SaveGamelistsOnExit"] = true;
+	mIntMap["GamelistSaveInterval"] = 0; // Seconds between background gamelist saves, 0 = only on exit
+	mStringMap["ScriptHost"] = ""; // Long-lived process receiving async script events on stdin, instead of running scripts
 	mStringMap["ShowBattery"] = "text";
 	mBoolMap["CheckBiosesAtLaunch"] = true;
 	mBoolMap["RemoveMultiDiskContent"] = true;
@@ -331,6 +333,8 @@ void Settings::setDefaults()
 #endif
 
 	mBoolMap["HideWindowFullReinit"] = false;
+	mIntMap["GameReturnCacheSize"] = 32; // MB of textures kept compressed in RAM while a game runs, 0 = disabled
+	mIntMap["PageCacheSize"] = 200; // MB of rendered PDF/CBZ pages kept on disk between sessions, 0 = disabled
 
 	mIntMap["WindowWidth"]   = 0;
 	mIntMap["WindowHeight"]  = 0;
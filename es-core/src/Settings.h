@@ -118,6 +118,10 @@ public:
 	DEFINE_STRING_SETTING(GameTransitionStyle)		
 	DEFINE_STRING_SETTING(PowerSaverMode)		
 	DEFINE_INT_SETTING(RecentlyScrappedFilter)
+	DEFINE_INT_SETTING(GamelistSaveInterval)
+	DEFINE_INT_SETTING(GameReturnCacheSize)
+	DEFINE_INT_SETTING(PageCacheSize)
+	DEFINE_STRING_SETTING(ScriptHost)
 
 	static Delegate<ISettingsChangedEvent> settingChanged;
 
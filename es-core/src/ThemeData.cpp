@@ -21,6 +21,7 @@
 #include "Settings.h"
 #include "SystemConf.h"
 #include <algorithm>
+#include <mutex>
 #include "LocaleES.h"
 #include "anim/ThemeStoryboard.h"
 #include "Paths.h"
@@ -661,6 +662,103 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 std::shared_ptr<ThemeData::ThemeMenu> ThemeData::mMenuTheme;
 ThemeData* ThemeData::mDefaultTheme = nullptr;
 
+// System themes are loaded from several threads, and each one resets the menu theme
+static std::mutex _menuThemeLock;
+
+// Parsed theme files, shared while a DocumentCacheActivator is alive
+static std::unordered_map<std::string, std::shared_ptr<pugi::xml_document>> _documentCache;
+static std::mutex _documentCacheLock;
+
+int ThemeData::DocumentCacheActivator::mReferenceCount = 0;
+
+ThemeData::DocumentCacheActivator::DocumentCacheActivator()
+{
+	std::unique_lock<std::mutex> lock(_documentCacheLock);
+	mReferenceCount++;
+}
+
+ThemeData::DocumentCacheActivator::~DocumentCacheActivator()
+{
+	std::unique_lock<std::mutex> lock(_documentCacheLock);
+
+	mReferenceCount--;
+	if (mReferenceCount <= 0)
+	{
+		mReferenceCount = 0;
+		_documentCache.clear();
+	}
+}
+
+std::shared_ptr<pugi::xml_document> ThemeData::loadDocument(const std::string& path, bool fromFile, pugi::xml_parse_result& result)
+{
+	if (fromFile)
+	{
+		std::unique_lock<std::mutex> lock(_documentCacheLock);
+
+		auto it = _documentCache.find(path);
+		if (it != _documentCache.cend())
+		{
+			result.status = pugi::status_ok;
+			return it->second;
+		}
+	}
+
+	// Parse outside of the lock, two threads may parse the same file at the same time : the first one stored is kept
+	auto doc = std::make_shared<pugi::xml_document>();
+	result = fromFile ? doc->load_file(WINSTRINGW(path).c_str()) : doc->load_string(path.c_str());
+	if (!result)
+		return doc;
+
+	normalizeDocument(*doc);
+
+	if (fromFile)
+	{
+		std::unique_lock<std::mutex> lock(_documentCacheLock);
+		if (DocumentCacheActivator::isEnabled())
+			return _documentCache.emplace(path, doc).first->second;
+	}
+
+	return doc;
+}
+
+// Shared documents must stay read-only while they are parsed : rewrite once what used to be changed in place during the parsing
+void ThemeData::normalizeDocument(const pugi::xml_node& root)
+{
+	for (pugi::xml_node node = root.first_child(); node; node = node.next_sibling())
+	{
+		if (node.type() != pugi::node_element)
+			continue;
+
+		if (strcmp(node.name(), "subset") == 0)
+		{
+			// <include> items of a <subset> inherit its attributes. displayName is resolved later, by parseSubset
+			const std::string name = node.attribute("name").as_string();
+			const std::string displayName = node.attribute("displayName").as_string();
+			const std::string appliesTo = node.attribute("appliesTo").as_string();
+
+			for (pugi::xml_node include = node.child("include"); include; include = include.next_sibling("include"))
+			{
+				include.remove_attribute("subset");
+				include.append_attribute("subset") = name.c_str();
+
+				if (!appliesTo.empty())
+				{
+					include.remove_attribute("appliesTo");
+					include.append_attribute("appliesTo") = appliesTo.c_str();
+				}
+
+				if (!displayName.empty())
+				{
+					include.remove_attribute("subSetDisplayName");
+					include.append_attribute("subSetDisplayName") = displayName.c_str();
+				}
+			}
+		}
+
+		normalizeDocument(node);
+	}
+}
+
 #define MINIMUM_THEME_FORMAT_VERSION 3
 #define CURRENT_THEME_FORMAT_VERSION 6
 
@@ -765,12 +863,12 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 			mEvaluatorVariables[var.first] = var.second;		
 	}
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = fromFile ? doc.load_file(WINSTRINGW(path).c_str()) : doc.load_string(path.c_str());
+	pugi::xml_parse_result res;
+	auto doc = loadDocument(path, fromFile, res);
 	if(!res)
 		throw error << "XML parsing error: \n    " << res.description();
 
-	pugi::xml_node root = doc.child("theme");
+	pugi::xml_node root = doc->child("theme");
 	if(!root)
 		throw error << "Missing <theme> tag!";
 
@@ -803,13 +901,16 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 
 	if (system != "splash" && system != "imageviewer" && system != "default")
 	{
+		std::unique_lock<std::mutex> lock(_menuThemeLock);
 		mMenuTheme = nullptr;
 		mDefaultTheme = this;
 	}
 }
 
-const std::shared_ptr<ThemeData::ThemeMenu>& ThemeData::getMenuTheme()
+std::shared_ptr<ThemeData::ThemeMenu> ThemeData::getMenuTheme()
 {
+	std::unique_lock<std::mutex> lock(_menuThemeLock);
+
 	if (mMenuTheme == nullptr)
 	{
 		if (mDefaultTheme != nullptr)
@@ -1436,29 +1537,9 @@ void ThemeData::parseSubsetElement(const pugi::xml_node& root)
 	if (!parseFilterAttributes(root))
 		return;
 
-	const std::string name = root.attribute("name").as_string();
-	const std::string displayName = resolvePlaceholders(root.attribute("displayName").as_string());
-	const std::string appliesTo = root.attribute("appliesTo").as_string();
-
+	// The subset attributes were copied to the <include> items by normalizeDocument
 	for (pugi::xml_node node = root.child("include"); node; node = node.next_sibling("include"))
-	{
-		node.remove_attribute("subset");
-		node.append_attribute("subset") = name.c_str();
-
-		if (!appliesTo.empty())
-		{
-			node.remove_attribute("appliesTo");
-			node.append_attribute("appliesTo") = appliesTo.c_str();
-		}
-
-		if (!displayName.empty())
-		{
-			node.remove_attribute("subSetDisplayName");
-			node.append_attribute("subSetDisplayName") = displayName.c_str();
-		}
-
 		parseInclude(node);
-	}
 }
 
 void ThemeData::parseViews(const pugi::xml_node& root)
@@ -1933,6 +2014,10 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 
 		std::string name = node.name();
 
+		// imagegrid's old <animate> was renamed to animateSelection in the document when first parsed : it only applies from the next parsing
+		if (name == "animate" && strcmp(root.name(), "imagegrid") == 0 && mAnimateNodes.find(node) != mAnimateNodes.cend())
+			name = "animateSelection";
+
 		ElementPropertyType type = STRING;
 
 		auto typeIt = typeMap.find(name);
@@ -2004,8 +2089,8 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 			// Exception for menuIcons that can be extended
 			if (element.type == "menuIcons")
 				type = PATH;
-			else if (name == "animate" && std::string(root.name()) == "imagegrid")
-				node.set_name("animateSelection");
+			else if (name == "animate" && strcmp(root.name(), "imagegrid") == 0)
+				mAnimateNodes.insert(node);
 			else if (element.type == "shader" || element.type == "screenshader" || element.type == "menuShader" || element.type == "fadeShader")
 			{
 				// Child properties of shaders are to be added dynamically. They can't be described here as they are used for uniforms arguments, except "path"
@@ -2540,6 +2625,7 @@ ThemeData::ThemeMenu::ThemeMenu(ThemeData* theme)
 
 void ThemeData::setDefaultTheme(ThemeData* theme) 
 { 
+	std::unique_lock<std::mutex> lock(_menuThemeLock);
 	mDefaultTheme = theme; 
 	mMenuTheme = nullptr;
 };
@@ -2673,8 +2759,8 @@ bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 	mPaths.push_back(path);
 	mVariables["currentPath"] = Utils::FileSystem::getParent(mPaths.back());
 
-	pugi::xml_document includeDoc;
-	pugi::xml_parse_result result = includeDoc.load_file(WINSTRINGW(path).c_str());
+	pugi::xml_parse_result result;
+	auto includeDoc = loadDocument(path, true, result);
 	if (!result)
 	{
 		mPaths.pop_back();
@@ -2686,7 +2772,7 @@ bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 		return false;
 	}
 
-	pugi::xml_node theme = includeDoc.child("theme");
+	pugi::xml_node theme = includeDoc->child("theme");
 	if (!theme)
 	{
 		mPaths.pop_back();
@@ -2729,6 +2815,7 @@ bool ThemeData::parseCustomShader(const ThemeData::ThemeElement* elem, Renderer:
 			if (!path.empty()) //ResourceManager::getInstance()->fileExists(path))
 			{
 				pShader->path = path;
+				Renderer::preloadShader(path);
 
 				for (auto prop : child.second.properties)
 				{
@@ -345,7 +345,7 @@ public:
 	static std::string getThemeFromCurrentSet(const std::string& system);
 	
 	bool hasSubsets() { return mSubsets.size() > 0; }
-	static const std::shared_ptr<ThemeData::ThemeMenu>& getMenuTheme();
+	static std::shared_ptr<ThemeData::ThemeMenu> getMenuTheme();
 
 	std::vector<Subset>		    getSubSets() { return mSubsets; }
 	std::vector<std::string>	getSubSetNames(const std::string ofView = "");
@@ -377,6 +377,19 @@ public:
 	std::shared_ptr<ThemeData> clone(const std::string& viewName);
 	bool appendFile(const std::string& path, bool perGameOverride = false);
 
+	// While an activator is alive, theme files are parsed once and their documents are shared by every ThemeData being loaded, from any thread
+	class DocumentCacheActivator
+	{
+	public:
+		DocumentCacheActivator();
+		~DocumentCacheActivator();
+
+		static bool isEnabled() { return mReferenceCount > 0; }
+
+	private:
+		static int mReferenceCount;
+	};
+
 	static bool parseCustomShader(const ThemeData::ThemeElement* elem, Renderer::ShaderInfo* pShader, const std::string& type = "shader");
 
 private:
@@ -415,6 +428,9 @@ private:
 	void parseCustomViewBaseClass(const pugi::xml_node& root, ThemeView& view, std::string baseClass);
 	bool findPropertyFromBaseClass(const std::string& typeName, const std::string& propertyName, ElementPropertyType& type);
 
+	static std::shared_ptr<pugi::xml_document> loadDocument(const std::string& path, bool fromFile, pugi::xml_parse_result& result);
+	static void normalizeDocument(const pugi::xml_node& root);
+
 	static GuiComponent* createExtraComponent(Window* window, const ThemeElement& elem, bool forceLoad = false);
 	static void applySelfTheme(GuiComponent* comp, const ThemeElement& elem);
 
@@ -484,6 +500,9 @@ private:
 
 	bool mPerGameOverrideTmp;
 
+	// imagegrid <animate> nodes already parsed : documents can be shared, they are not renamed in place anymore
+	std::set<pugi::xml_node> mAnimateNodes;
+
 	Utils::MathExpr::ValueMap mEvaluatorVariables;
 };
 
@@ -25,6 +25,7 @@
 #include "Splash.h"
 #include "PowerSaver.h"
 #include "renderers/Renderer.h"
+#include "utils/TaskScheduler.h"
 
 #if WIN32
 #include <SDL_syswm.h>
@@ -41,10 +42,14 @@ Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCoun
 
 	mSplash = nullptr;
 	mLastShowCursor = -2;
+
+	Utils::TaskScheduler::setUiDispatcher([this](const std::function<void()>& func) { postToUiThread(func); });
 }
 
 Window::~Window()
 {
+	Utils::TaskScheduler::setUiDispatcher(nullptr);
+
 	resetMenuBackgroundShader();
 
 	for (auto extra : mScreenExtras)
@@ -1,15 +1,44 @@
 #include "StoryboardAnimator.h"
 #include "PowerSaver.h"
+#include <cmath>
 
 StoryboardAnimator::StoryboardAnimator(GuiComponent* comp, ThemeStoryboard* storyboard)
 {
 	mHasInitialProperties = false;
+	mSettersResolved = false;
 	mPaused = true;
 	mComponent = comp;
 
 	mStoryBoard = new ThemeStoryboard(*storyboard);
 	mRepeatCount = 0;
 	mCurrentTime = 0;
+	mFinishedStories = 0;
+
+	// Resolve the properties once : stories only keep an index to them
+	size_t count = mStoryBoard->animations.size();
+
+	mStoryProperty.resize(count);
+	mStoryState.resize(count, STORY_PENDING);
+	mStoryReversed.resize(count, 0);
+	mStoryTime.resize(count, 0);
+	mStoryRepeatCount.resize(count, 0);
+	mRunningStories.reserve(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto anim = mStoryBoard->animations[i];
+
+		int property = getPropertyIndex(anim->propertyName);
+		mStoryProperty[i] = property;
+
+		if (anim->enabled && anim->begin == 0)
+			mProperties[property].assignedAtZero = true;
+	}
+
+	mSoundProperty = -1;
+	for (int i = 0; i < (int)mProperties.size(); i++)
+		if (mProperties[i].name == "sound")
+			mSoundProperty = i;
 }
 
 StoryboardAnimator::~StoryboardAnimator()
@@ -17,23 +46,47 @@ StoryboardAnimator::~StoryboardAnimator()
 	delete mStoryBoard;
 
 	pause();
+}
 
-	for (auto story : _currentStories)
-		delete story;
+int StoryboardAnimator::getPropertyIndex(const std::string& name)
+{
+	for (int i = 0; i < (int)mProperties.size(); i++)
+		if (mProperties[i].name == name)
+			return i;
 
-	_currentStories.clear();
+	mProperties.push_back(AnimatedProperty(name));
+	return (int)mProperties.size() - 1;
+}
+
+void StoryboardAnimator::applyProperty(int property, const ThemeData::ThemeElement::Property& value)
+{
+	auto& prop = mProperties[property];
+	if (prop.disabled)
+		return;
+
+	if (prop.setter != nullptr)
+		mComponent->applyProperty(prop.setter, value);
+	else
+		mComponent->setProperty(prop.name, value);
 }
 
 void StoryboardAnimator::clearStories()
 {
-	for (auto story : _finishedStories)
-		delete story;
+	for (size_t i = 0; i < mStoryState.size(); i++)
+		mStoryState[i] = STORY_PENDING;
 
-	for (auto story : _currentStories)
-		delete story;
+	mRunningStories.clear();
+	mFinishedStories = 0;
+}
+
+void StoryboardAnimator::startStory(int index)
+{
+	mStoryState[index] = STORY_RUNNING;
+	mStoryReversed[index] = 0;
+	mStoryTime[index] = 0;
+	mStoryRepeatCount[index] = 0;
 
-	_finishedStories.clear();
-	_currentStories.clear();
+	mRunningStories.push_back(index);
 }
 
 void StoryboardAnimator::reset(int atTime, bool resetInitialProperties)
@@ -48,11 +101,18 @@ void StoryboardAnimator::reset(int atTime, bool resetInitialProperties)
 
 	clearStories();
 
+	auto& animations = mStoryBoard->animations;
+
 	if (atTime > 0)
 	{
-		for (auto anim : mStoryBoard->animations)
-			if (anim->enabled && (anim->begin + anim->duration <= atTime))
-				_finishedStories.push_back(new StoryAnimation(anim));
+		for (size_t i = 0; i < animations.size(); i++)
+		{
+			if (animations[i]->enabled && (animations[i]->begin + animations[i]->duration <= atTime))
+			{
+				mStoryState[i] = STORY_FINISHED;
+				mFinishedStories++;
+			}
+		}
 
 		addNewAnimations();
 	}
@@ -62,49 +122,41 @@ void StoryboardAnimator::reset(int atTime, bool resetInitialProperties)
 
 		if (mHasInitialProperties && resetInitialProperties)
 		{
-			for (auto prop : mInitialProperties)
+			for (int i = 0; i < (int)mProperties.size(); i++)
 			{
-				if (mDisabledProperties.find(prop.first) != mDisabledProperties.cend())
+				auto& prop = mProperties[i];
+				if (!prop.hasInitialValue || (atTime == 0 && prop.assignedAtZero))
 					continue;
 
-				bool hasAssignationAtZero = false;
-
-				if (atTime == 0)
-				{
-					for (auto anim : mStoryBoard->animations)
-						if (anim->enabled && anim->begin == 0 && anim->propertyName == prop.first)
-							hasAssignationAtZero = true;
-				}
-
-				if (!hasAssignationAtZero)
-					mComponent->setProperty(prop.first, prop.second);
+				applyProperty(i, prop.initialValue);
 			}
 		}
 
-		for (auto anim : mStoryBoard->animations)
-			if (anim->enabled && anim->begin == 0)
-				_currentStories.push_back(new StoryAnimation(anim));
+		for (size_t i = 0; i < animations.size(); i++)
+			if (animations[i]->enabled && animations[i]->begin == 0)
+				startStory(i);
 	}
 }
 
 void StoryboardAnimator::clearInitialProperties()
-{	
-	mInitialProperties.clear();
+{
+	for (auto& prop : mProperties)
+		prop.hasInitialValue = false;
 }
 
 void StoryboardAnimator::stop()
 {
 	pause();
 
-	for (auto prop : mInitialProperties)
-		if (mDisabledProperties.find(prop.first) == mDisabledProperties.cend())
-			mComponent->setProperty(prop.first, prop.second);
+	for (int i = 0; i < (int)mProperties.size(); i++)
+		if (mProperties[i].hasInitialValue)
+			applyProperty(i, mProperties[i].initialValue);
 
 	clearStories();
 }
 
 void StoryboardAnimator::pause()
-{ 
+{
 	if (!mPaused)
 	{
 		PowerSaver::resume();
@@ -114,31 +166,142 @@ void StoryboardAnimator::pause()
 
 void StoryboardAnimator::addNewAnimations()
 {
-	for (auto anim : mStoryBoard->animations)
+	auto& animations = mStoryBoard->animations;
+
+	for (size_t i = 0; i < animations.size(); i++)
 	{
-		if (!anim->enabled)
+		if (mStoryState[i] != STORY_PENDING)
 			continue;
 
-		bool exists = false;
+		auto anim = animations[i];
+		if (!anim->enabled || mCurrentTime < anim->begin)
+			continue;
+
+		anim->ensureInitialValue(mComponent->getProperty(anim->propertyName));
+		startStory(i);
+	}
+}
+
+// Steps the story, and computes the eased value to apply. Returns false when the story has ended.
+bool StoryboardAnimator::updateStory(int index, int elapsed, float& value)
+{
+	ThemeAnimation* animation = mStoryBoard->animations[index];
+
+	int& currentTime = mStoryTime[index];
+	unsigned char& isReversed = mStoryReversed[index];
+
+	if (isReversed)
+		currentTime -= elapsed;
+	else
+		currentTime += elapsed;
+
+	bool ended = false;
+	bool pseudoEnd = false;
 
-		for (auto story : _currentStories)
-			if (story->animation == anim) { exists = true; break; }
+	if (!isReversed && currentTime > animation->duration)
+	{
+		if (animation->autoReverse)
+		{
+			isReversed = 1;
+			currentTime = animation->duration;
+		}
+		else
+		{
+			pseudoEnd = true;
+			currentTime = 0;
+		}
+	}
+	else if (isReversed && currentTime < 0)
+	{
+		currentTime = 0;
+		isReversed = 0;
+		pseudoEnd = true;
+	}
 
-		if (!exists && _finishedStories.size())
+	if (pseudoEnd)
+	{
+		if (animation->repeat == 1)
+			ended = true;
+		else if (animation->repeat > 1)
 		{
-			for (auto story : _finishedStories)
-				if (story->animation == anim) { exists = true; break; }
+			mStoryRepeatCount[index]++;
+			if (mStoryRepeatCount[index] >= animation->repeat)
+				ended = true;
+			else
+				currentTime = 0;
 		}
+	}
 
-		if (exists)
-			continue;
+	if (ended || animation->duration == 0)
+	{
+		value = animation->autoReverse ? 0.0f : 1.0f;
+		return false;
+	}
 
-		if (mCurrentTime >= anim->begin)
+	value = 0;
+
+	if (currentTime >= animation->duration)
+		value = 1;
+	else
+	{
+		float b = 0;
+		float c = 1;
+
+		float t = currentTime / (float)animation->duration;
+		if (t > 1)
+			t = 1;
+
+		switch (animation->easingMode)
 		{
-			anim->ensureInitialValue(mComponent->getProperty(anim->propertyName));
-			_currentStories.push_back(new StoryAnimation(anim));
+		case ThemeAnimation::EasingMode::EaseIn:
+			value = (t * t + b);
+			break;
+
+		case ThemeAnimation::EasingMode::EaseInCubic:
+			value = t * t * t;
+			break;
+
+		case ThemeAnimation::EasingMode::EaseInQuint:
+			value = t * t * t * t * t;
+			break;
+
+		case ThemeAnimation::EasingMode::EaseOut:
+			value = (-c * t * (t - 2.0f));
+			break;
+
+		case ThemeAnimation::EasingMode::EaseOutCubic:
+			t = t - 1.0f;
+			value = t * t * t + 1.0f;
+			break;
+
+		case ThemeAnimation::EasingMode::EaseOutQuint:
+			t = t - 1.0f;
+			value = t * t * t * t * t + 1.0f;
+			break;
+
+		case ThemeAnimation::EasingMode::EaseInOut:
+			t = currentTime / ((float)animation->duration / 2.0f);
+			if (t < 1)
+				value = t * t / 2.0f;
+			else
+			{
+				t--;
+				value = (-c / 2.0f * (t * (t - 2.0f) - 1.0f));
+			}
+			break;
+
+		case ThemeAnimation::EasingMode::Bump:
+			#define PIVAL 3.141592653589793238462643383279502884L
+			value = sin((PIVAL / 2.0) * t) + sin(PIVAL * t) / 2.0;
+			break;
+
+		default:
+			value = t;
+			break;
 		}
 	}
+
+	return true;
 }
 
 bool StoryboardAnimator::update(int elapsed)
@@ -146,25 +309,45 @@ bool StoryboardAnimator::update(int elapsed)
 	if (mPaused || elapsed > 500)
 		return true;
 
+	auto& animations = mStoryBoard->animations;
+
+	if (!mSettersResolved)
+	{
+		// Done at first update : the component has its final parent by now
+		mSettersResolved = true;
+
+		for (auto& prop : mProperties)
+			prop.setter = mComponent->getPropertySetter(prop.name);
+	}
+
 	if (!mHasInitialProperties)
 	{
 		mHasInitialProperties = true;
 
-		for (auto anim : mStoryBoard->animations)
-			if (anim->enabled && anim->propertyName != "sound") // Sound is always initially empty
-				mInitialProperties[anim->propertyName] = mComponent->getProperty(anim->propertyName);
+		for (size_t i = 0; i < animations.size(); i++)
+		{
+			auto& prop = mProperties[mStoryProperty[i]];
+			if (!animations[i]->enabled || prop.hasInitialValue || (int)mStoryProperty[i] == mSoundProperty) // Sound is always initially empty
+				continue;
+
+			prop.initialValue = mComponent->getProperty(prop.name);
+			prop.hasInitialValue = true;
+		}
 
-		for (auto anim : mStoryBoard->animations)
+		for (size_t i = 0; i < animations.size(); i++)
 		{
-			if (anim->begin == 0 && anim->enabled)
-			{
-				if (anim->to.type == ThemeData::ThemeElement::Property::Unknown)
-					anim->to = anim->propertyName == "sound" ? std::string() : mComponent->getProperty(anim->propertyName);
-				if (anim->from.type == ThemeData::ThemeElement::Property::Unknown)
-					anim->from = anim->propertyName == "sound" ? std::string() : mComponent->getProperty(anim->propertyName);
-				else if (mDisabledProperties.find(anim->propertyName) == mDisabledProperties.cend())
-					mComponent->setProperty(anim->propertyName, anim->from);
-			}
+			auto anim = animations[i];
+			if (anim->begin != 0 || !anim->enabled)
+				continue;
+
+			bool isSound = mStoryProperty[i] == mSoundProperty;
+
+			if (anim->to.type == ThemeData::ThemeElement::Property::Unknown)
+				anim->to = isSound ? std::string() : mComponent->getProperty(anim->propertyName);
+			if (anim->from.type == ThemeData::ThemeElement::Property::Unknown)
+				anim->from = isSound ? std::string() : mComponent->getProperty(anim->propertyName);
+			else
+				applyProperty(mStoryProperty[i], anim->from);
 		}
 	}
 
@@ -172,29 +355,30 @@ bool StoryboardAnimator::update(int elapsed)
 
 	addNewAnimations();
 
-	for (int i = _currentStories.size() - 1; i >= 0; i--)
+	// Step all running stories in one pass
+	for (int i = (int)mRunningStories.size() - 1; i >= 0; i--)
 	{
-		auto story = _currentStories[i];
-		bool ended = !story->update(elapsed);
+		int index = mRunningStories[i];
+		int property = mStoryProperty[index];
 
-		if (mDisabledProperties.find(story->animation->propertyName) == mDisabledProperties.cend())
-			mComponent->setProperty(story->animation->propertyName, story->currentValue);
+		float value;
+		bool ended = !updateStory(index, elapsed, value);
+
+		applyProperty(property, animations[index]->computeValue(value));
 
 		if (ended)
 		{
-			if (story->animation->propertyName == "sound")
+			if (property == mSoundProperty)
 				mComponent->setProperty("sound", std::string());
 
-			_finishedStories.push_back(story);
+			mStoryState[index] = STORY_FINISHED;
+			mFinishedStories++;
 
-			auto it = _currentStories.begin();
-			std::advance(it, i);
-			_currentStories.erase(it);
-			continue;
+			mRunningStories.erase(mRunningStories.begin() + i);
 		}
 	}
 
-	if (_finishedStories.size() == mStoryBoard->animations.size())
+	if (mFinishedStories == (int)animations.size())
 	{
 		if (mStoryBoard->repeat == 1)
 		{
@@ -230,8 +414,7 @@ const std::string StoryboardAnimator::getName()
 
 void StoryboardAnimator::enableProperty(const std::string& name, bool enable)
 {
-	mDisabledProperties.erase(name);
-
-	if (!enable)
-		mDisabledProperties.insert(name);
-}
\ No newline at end of file
+	for (auto& prop : mProperties)
+		if (prop.name == name)
+			prop.disabled = !enable;
+}
@@ -1073,6 +1073,15 @@ ThemeData::ThemeElement::Property ImageComponent::getProperty(const std::string
 	return GuiComponent::getProperty(name);
 }
 
+GuiComponent::PropertySetter ImageComponent::getPropertySetter(const std::string& name)
+{
+	// Width & height also update the target size
+	if (name == "w" || name == "h")
+		return nullptr;
+
+	return GuiComponent::getPropertySetter(name);
+}
+
 void ImageComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
 {	
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
@@ -66,7 +66,10 @@ void PostProcessShaderComponent::applyTheme(const std::shared_ptr<ThemeData>& th
 		return;
 
 	if (elem->has("path"))
+	{
 		mShaderPath = elem->get<std::string>("path");
+		Renderer::preloadShader(mShaderPath);
+	}
 
 	for (auto prop : elem->properties)
 	{
@@ -23,7 +23,7 @@ class TextCache;
 struct TextListData
 {
 	unsigned int colorId;
-	std::shared_ptr<TextCache> textCache;
+	std::weak_ptr<TextCache> textCache; // owned by the list's text cache ring
 	std::shared_ptr<GuiComponent> itemTemplate;
 };
 
@@ -91,6 +91,9 @@ public:
 		mFont = font;
 		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
 			it->data.textCache.reset();
+
+		mTextCacheRing.clear();
+		mTextCacheRingPos = 0;
 	}
 
 	inline void setUppercase(bool uppercase)
@@ -98,6 +101,9 @@ public:
 		mUppercase = uppercase;
 		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
 			it->data.textCache.reset();
+
+		mTextCacheRing.clear();
+		mTextCacheRingPos = 0;
 	}
 
 	inline void setSelectorHeight(float selectorScale) { mSelectorHeight = selectorScale; }
@@ -129,6 +135,8 @@ protected:
 
 private:
 	void  updateCameraOffset();
+	void  addToTextCacheRing(int entry, const std::shared_ptr<TextCache>& textCache, int screenCount);
+	void  releaseTextCache(const std::pair<int, std::shared_ptr<TextCache>>& item);
 	float getRowHeight() const;
 	float getTotalRowHeight() const;
 
@@ -176,6 +184,11 @@ private:
 	ScrollbarComponent mScrollbar;
 	float mCameraOffset;
 
+	// Row text caches are only kept for the last rows drawn, so scrolling a long list doesn't keep one vertex buffer per row.
+	// Each cache is stored with the index of the entry that refers to it
+	std::vector<std::pair<int, std::shared_ptr<TextCache>>> mTextCacheRing;
+	size_t mTextCacheRingPos;
+
 	int		  mHotRow;
 	int		  mPressedRow;
 	Vector2i  mPressedPoint;
@@ -205,6 +218,7 @@ TextListComponent<T>::TextListComponent(Window* window) :
 	IList<TextListData, T>(window), mSelectorImage(window), mScrollbar(window)
 {
 	mCameraOffset = 0;
+	mTextCacheRingPos = 0;
 	mLineCount = -1;
 	mMarqueeOffset = 0;
 	mMarqueeOffset2 = 0;
@@ -344,20 +358,25 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 			else
 				color = mColors[entry.data.colorId];
 
-			if (!entry.data.textCache)
-				entry.data.textCache = std::unique_ptr<TextCache>(font->buildTextCache(mUppercase ? Utils::String::toUpper(entry.name) : entry.name, 0, 0, 0x000000FF));
+			std::shared_ptr<TextCache> textCache = entry.data.textCache.lock();
+			if (!textCache)
+			{
+				textCache = std::shared_ptr<TextCache>(font->buildTextCache(mUppercase ? Utils::String::toUpper(entry.name) : entry.name, 0, 0, 0x000000FF));
+				entry.data.textCache = textCache;
+				addToTextCacheRing(i, textCache, screenCount);
+			}
 
 			if (mCursor == i && mHasBonusSelectedColor)
-				entry.data.textCache->setColors(color, mBonusSelectedColor);
+				textCache->setColors(color, mBonusSelectedColor);
 			else if (mHasBonusColor)
-				entry.data.textCache->setColors(color, mBonusColor);
+				textCache->setColors(color, mBonusColor);
 			else
-				entry.data.textCache->setColor(color);
+				textCache->setColor(color);
 
 			Vector3f offset(0, y, 0);
 
 			if (mLineCount > 0) // Vertical center
-				offset[1] += (int)((entrySize - entry.data.textCache->metrics.size.y()) / 2);
+				offset[1] += (int)((entrySize - textCache->metrics.size.y()) / 2);
 
 			switch (mAlignment)
 			{
@@ -365,12 +384,12 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 				offset[0] = mHorizontalMargin;
 				break;
 			case ALIGN_CENTER:
-				offset[0] = (int)((mSize.x() - entry.data.textCache->metrics.size.x()) / 2);
+				offset[0] = (int)((mSize.x() - textCache->metrics.size.x()) / 2);
 				if (offset[0] < mHorizontalMargin)
 					offset[0] = mHorizontalMargin;
 				break;
 			case ALIGN_RIGHT:
-				offset[0] = (mSize.x() - entry.data.textCache->metrics.size.x());
+				offset[0] = (mSize.x() - textCache->metrics.size.x());
 				offset[0] -= mHorizontalMargin;
 				if (offset[0] < mHorizontalMargin)
 					offset[0] = mHorizontalMargin;
@@ -420,7 +439,7 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 					mSelectorColorGradientHorizontal);
 			}
 
-			font->renderTextCacheEx(entry.data.textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, getOpacity());
+			font->renderTextCacheEx(textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, getOpacity());
 
 			// render currently selected item text again if
 			// marquee is scrolled far enough for it to repeat
@@ -429,7 +448,7 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 				drawTrans = trans;
 				drawTrans.translate(offset - Vector3f((float)mMarqueeOffset2, 0, 0));
 
-				font->renderTextCacheEx(entry.data.textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, getOpacity());
+				font->renderTextCacheEx(textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, getOpacity());
 			}
 		}
 
@@ -579,6 +598,43 @@ void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned i
 	static_cast<IList< TextListData, T >*>(this)->add(entry);
 }
 
+template <typename T>
+void TextListComponent<T>::addToTextCacheRing(int entry, const std::shared_ptr<TextCache>& textCache, int screenCount)
+{
+	// Room for the visible rows, plus a screen of margin on each side for scrolling back and forth
+	size_t capacity = (size_t)Math::max(32, screenCount * 3);
+
+	if (mTextCacheRing.size() < capacity)
+	{
+		mTextCacheRing.push_back(std::make_pair(entry, textCache));
+		return;
+	}
+
+	if (mTextCacheRing.size() > capacity)
+	{
+		while (mTextCacheRing.size() > capacity)
+		{
+			releaseTextCache(mTextCacheRing.back());
+			mTextCacheRing.pop_back();
+		}
+
+		mTextCacheRingPos = 0;
+	}
+
+	// The ring's oldest cache is released, and its row is rebuilt if it is drawn again
+	releaseTextCache(mTextCacheRing[mTextCacheRingPos]);
+	mTextCacheRing[mTextCacheRingPos] = std::make_pair(entry, textCache);
+	mTextCacheRingPos = (mTextCacheRingPos + 1) % capacity;
+}
+
+template <typename T>
+void TextListComponent<T>::releaseTextCache(const std::pair<int, std::shared_ptr<TextCache>>& item)
+{
+	// An expired weak reference still holds the cache's control block : drop it, unless the entries changed meanwhile
+	if (item.first >= 0 && item.first < (int)mEntries.size() && mEntries[item.first].data.textCache.lock() == item.second)
+		mEntries[item.first].data.textCache.reset();
+}
+
 template <typename T>
 void TextListComponent<T>::onSizeChanged()
 {
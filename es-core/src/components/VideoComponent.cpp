@@ -578,6 +578,15 @@ ThemeData::ThemeElement::Property VideoComponent::getProperty(const std::string
 	return GuiComponent::getProperty(name);
 }
 
+GuiComponent::PropertySetter VideoComponent::getPropertySetter(const std::string& name)
+{
+	// Also forwarded to the snapshot image
+	if (name == "offset" || name == "offsetX" || name == "offsetY" || name == "scale")
+		return nullptr;
+
+	return GuiComponent::getPropertySetter(name);
+}
+
 void VideoComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
 {
 	if (hasStoryBoard() && !mStaticImage.hasStoryBoard("snapshot"))
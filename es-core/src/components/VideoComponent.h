@@ -156,6 +156,7 @@ public:
 
 	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
 	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	PropertySetter getPropertySetter(const std::string& name) override;
 
 	virtual void setClipRect(const Vector4f& vec);
 
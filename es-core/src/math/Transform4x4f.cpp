@@ -1,10 +1,72 @@
 #include "math/Transform4x4f.h"
 
+// Products of transforms and points run for every component on every frame : they use SSE2 when the target has it.
+// The scalar code is kept for the other targets, and when building with -DDISABLE_SIMD=ON (ES_MATH_NO_SIMD).
+// The NEON kernels have not been verified on ARM hardware yet : they are only built with -DENABLE_NEON_MATH=ON (ES_MATH_ENABLE_NEON).
+// Every kernel multiplies and adds in the same order as the scalar code.
+#if !defined(ES_MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ES_MATH_SSE2
+#include <emmintrin.h>
+#elif !defined(ES_MATH_NO_SIMD) && defined(ES_MATH_ENABLE_NEON) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define ES_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(ES_MATH_SSE2)
+
+// _r0 * _v[0] + _r1 * _v[1] + _r2 * _v[2]
+static inline __m128 combineRows(const __m128 _r0, const __m128 _r1, const __m128 _r2, const float* _v)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_r0, _mm_set1_ps(_v[0])), _mm_mul_ps(_r1, _mm_set1_ps(_v[1]))), _mm_mul_ps(_r2, _mm_set1_ps(_v[2])));
+}
+
+#elif defined(ES_MATH_NEON)
+
+static inline float32x4_t combineRows(const float32x4_t _r0, const float32x4_t _r1, const float32x4_t _r2, const float* _v)
+{
+	return vaddq_f32(vaddq_f32(vmulq_n_f32(_r0, _v[0]), vmulq_n_f32(_r1, _v[1])), vmulq_n_f32(_r2, _v[2]));
+}
+
+#endif
+
 const Transform4x4f Transform4x4f::operator*(const Transform4x4f& _other) const
 {
 	const float* tm = (float*)this;
 	const float* om = (float*)&_other;
 
+#if defined(ES_MATH_SSE2)
+	const __m128 r0 = _mm_loadu_ps(tm);
+	const __m128 r1 = _mm_loadu_ps(tm + 4);
+	const __m128 r2 = _mm_loadu_ps(tm + 8);
+	const __m128 r3 = _mm_loadu_ps(tm + 12);
+	const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+	Transform4x4f result;
+	float* rm = (float*)&result;
+
+	_mm_storeu_ps(rm,      _mm_and_ps(combineRows(r0, r1, r2, om), xyz));
+	_mm_storeu_ps(rm +  4, _mm_and_ps(combineRows(r0, r1, r2, om + 4), xyz));
+	_mm_storeu_ps(rm +  8, _mm_and_ps(combineRows(r0, r1, r2, om + 8), xyz));
+	_mm_storeu_ps(rm + 12, _mm_and_ps(_mm_add_ps(combineRows(r0, r1, r2, om + 12), r3), xyz));
+	rm[15] = 1;
+
+	return result;
+#elif defined(ES_MATH_NEON)
+	const float32x4_t r0 = vld1q_f32(tm);
+	const float32x4_t r1 = vld1q_f32(tm + 4);
+	const float32x4_t r2 = vld1q_f32(tm + 8);
+	const float32x4_t r3 = vld1q_f32(tm + 12);
+
+	Transform4x4f result;
+	float* rm = (float*)&result;
+
+	vst1q_f32(rm,      vsetq_lane_f32(0, combineRows(r0, r1, r2, om), 3));
+	vst1q_f32(rm +  4, vsetq_lane_f32(0, combineRows(r0, r1, r2, om + 4), 3));
+	vst1q_f32(rm +  8, vsetq_lane_f32(0, combineRows(r0, r1, r2, om + 8), 3));
+	vst1q_f32(rm + 12, vsetq_lane_f32(1, vaddq_f32(combineRows(r0, r1, r2, om + 12), r3), 3));
+
+	return result;
+#else
 	return
 	{
 		{
@@ -32,6 +94,7 @@ const Transform4x4f Transform4x4f::operator*(const Transform4x4f& _other) const
 			1
 		}
 	};
+#endif
 
 } // operator*
 
@@ -40,12 +103,24 @@ const Vector3f Transform4x4f::operator*(const Vector3f& _other) const
 	const float* tm = (float*)this;
 	const float* ov = (float*)&_other;
 
+#if defined(ES_MATH_SSE2)
+	float rv[4];
+	_mm_storeu_ps(rv, _mm_add_ps(combineRows(_mm_loadu_ps(tm), _mm_loadu_ps(tm + 4), _mm_loadu_ps(tm + 8), ov), _mm_loadu_ps(tm + 12)));
+
+	return { rv[0], rv[1], rv[2] };
+#elif defined(ES_MATH_NEON)
+	float rv[4];
+	vst1q_f32(rv, vaddq_f32(combineRows(vld1q_f32(tm), vld1q_f32(tm + 4), vld1q_f32(tm + 8), ov), vld1q_f32(tm + 12)));
+
+	return { rv[0], rv[1], rv[2] };
+#else
 	return
 	{
 		tm[ 0] * ov[0] + tm[ 4] * ov[1] + tm[ 8] * ov[2] + tm[12],
 		tm[ 1] * ov[0] + tm[ 5] * ov[1] + tm[ 9] * ov[2] + tm[13],
 		tm[ 2] * ov[0] + tm[ 6] * ov[1] + tm[10] * ov[2] + tm[14]
 	};
+#endif
 
 } // operator*
 
@@ -125,6 +125,47 @@ namespace glext
 }
 #endif
 
+namespace glext
+{
+	PFNGETPROGRAMBINARYPROC glGetProgramBinary_ = nullptr;
+	PFNPROGRAMBINARYPROC    glProgramBinary_ = nullptr;
+
+	bool initializeProgramBinaryExtension()
+	{
+		glGetProgramBinary_ = nullptr;
+		glProgramBinary_ = nullptr;
+
+#if USE_OPENGLES_20
+		if (!SDL_GL_ExtensionSupported("GL_OES_get_program_binary"))
+			return false;
+
+		auto getProgramBinary = (PFNGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinaryOES");
+		auto programBinary = (PFNPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinaryOES");
+#else
+		if (!SDL_GL_ExtensionSupported("GL_ARB_get_program_binary"))
+			return false;
+
+		auto getProgramBinary = (PFNGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinary");
+		auto programBinary = (PFNPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinary");
+#endif
+
+		if (getProgramBinary == nullptr || programBinary == nullptr)
+			return false;
+
+		// The extension can be exposed with no binary format at all (Mesa software rasterizers do that)
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		while (glGetError() != GL_NO_ERROR);
+
+		if (formats <= 0)
+			return false;
+
+		glGetProgramBinary_ = getProgramBinary;
+		glProgramBinary_ = programBinary;
+		return true;
+	}
+}
+
 #include "Log.h"
 
 bool _GLCheckError(const char* _funcName)
@@ -56,5 +56,30 @@ using namespace glext;
 
 #endif
 
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// Optional program binaries (GL_ARB_get_program_binary / GL_OES_get_program_binary). Pointers stay null if unsupported
+namespace glext
+{
+#if USE_OPENGLES_20
+	typedef PFNGLGETPROGRAMBINARYOESPROC PFNGETPROGRAMBINARYPROC;
+	typedef PFNGLPROGRAMBINARYOESPROC    PFNPROGRAMBINARYPROC;
+#else
+	typedef PFNGLGETPROGRAMBINARYPROC    PFNGETPROGRAMBINARYPROC;
+	typedef PFNGLPROGRAMBINARYPROC       PFNPROGRAMBINARYPROC;
+#endif
+
+	bool initializeProgramBinaryExtension();
+
+	extern PFNGETPROGRAMBINARYPROC glGetProgramBinary_;
+	extern PFNPROGRAMBINARYPROC    glProgramBinary_;
+};
+
 #define GL_CHECK_ERROR(Function) (Function, _GLCheckError(#Function))
 bool _GLCheckError(const char* _funcName);
@@ -877,6 +877,11 @@ namespace Renderer
 		Instance()->bindTexture(_texture);
 	}
 
+	bool readTexture(const unsigned int _texture, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		return Instance()->readTexture(_texture, _width, _height, _data);
+	}
+
 	void drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
 		Instance()->drawLines(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor);
@@ -902,6 +907,11 @@ namespace Renderer
 		return Instance()->shaderSupportsCornerSize(shader);
 	}
 
+	void preloadShader(const std::string& path)
+	{
+		Instance()->preloadShader(path);
+	}
+
 	bool supportShaders()
 	{
 		return Instance()->supportShaders();
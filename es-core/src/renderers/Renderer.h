@@ -116,6 +116,9 @@ namespace Renderer
 		virtual void         updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data) = 0;
 		virtual void         bindTexture(const unsigned int _texture) = 0;
 
+		// Reads an RGBA texture back from VRAM. Returns false if the renderer can't do it
+		virtual bool         readTexture(const unsigned int _texture, const unsigned int _width, const unsigned int _height, void* _data) { return false; };
+
 		virtual void         drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) = 0;
 		virtual void         drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA, bool verticesChanged = true) = 0;
 		virtual void		 drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) = 0;
@@ -139,6 +142,9 @@ namespace Renderer
 
 		virtual bool		 supportShaders() { return false; }
 		virtual bool		 shaderSupportsCornerSize(const std::string& shader) { return false; };
+
+		// Hint that a shader will be needed soon : the renderer may read it in the background
+		virtual void		 preloadShader(const std::string& path) { };
 	};
 	
 	class ScreenSettings
@@ -189,6 +195,7 @@ namespace Renderer
 	void         destroyTexture    (const unsigned int _texture);
 	void         updateTexture     (const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data);
 	void         bindTexture       (const unsigned int _texture);
+	bool         readTexture       (const unsigned int _texture, const unsigned int _width, const unsigned int _height, void* _data);
 	void         drawLines         (const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA);
 	void         drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA, bool verticesChanged = true);
 	void		 drawSolidRectangle(const float _x, const float _y, const float _w, const float _h, const unsigned int _fillColor, const unsigned int _borderColor, float borderWidth = 1, float cornerRadius = 0);
@@ -207,6 +214,7 @@ namespace Renderer
 
 	bool		 supportShaders();
 	bool		 shaderSupportsCornerSize(const std::string& shader);
+	void		 preloadShader(const std::string& path);
 
 	std::string  getDriverName();
 	std::vector<std::pair<std::string, std::string>> getDriverInformation();
@@ -191,6 +191,17 @@ namespace Renderer
 
 	} // bindTexture
 
+	bool OpenGL21Renderer::readTexture(const unsigned int _texture, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		bindTexture(_texture);
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, _data);
+
+		return glGetError() == GL_NO_ERROR;
+
+	} // readTexture
+
 	void OpenGL21Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
 		glEnable(GL_BLEND);
@@ -218,6 +218,8 @@ namespace Renderer
 
 		LOG(LogInfo) << "GLSL version preprocessor :     " << SHADER_VERSION_STRING;
 
+		ShaderProgram::initializeBinaryCache();
+
 		// vertex shader (no texture)
 		std::string vertexSourceNoTexture =
 			SHADER_VERSION_STRING +
@@ -250,10 +252,7 @@ namespace Renderer
 			)=====";
 
 		// Compile each shader, link them to make a full program
-		auto vertexShaderNoTexture = Shader::createShader(GL_VERTEX_SHADER, vertexSourceNoTexture);
-		auto fragmentShaderColorNoTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceNoTexture);
-
-		shaderProgramColorNoTexture.createShaderProgram(vertexShaderNoTexture, fragmentShaderColorNoTexture);
+		shaderProgramColorNoTexture.createShaderProgram(vertexSourceNoTexture, fragmentSourceNoTexture);
 		
 		// vertex shader (texture)
 		std::string vertexSourceTexture =
@@ -328,9 +327,7 @@ namespace Renderer
 			)=====";
 
 		// Compile each shader, link them to make a full program
-		auto vertexShaderTexture = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
-		auto fragmentShaderColorTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceTexture);
-		shaderProgramColorTexture.createShaderProgram(vertexShaderTexture, fragmentShaderColorTexture);
+		shaderProgramColorTexture.createShaderProgram(vertexSourceTexture, fragmentSourceTexture);
 		
 		// fragment shader (alpha texture)
 		std::string fragmentSourceAlpha =
@@ -353,10 +350,7 @@ namespace Renderer
 			)=====";
 
 
-		auto vertexShaderAlpha = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
-		auto fragmentShaderAlpha = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceAlpha);
-
-		shaderProgramAlpha.createShaderProgram(vertexShaderAlpha, fragmentShaderAlpha);
+		shaderProgramAlpha.createShaderProgram(vertexSourceTexture, fragmentSourceAlpha);
 		
 		useProgram(nullptr);
 
@@ -822,6 +816,34 @@ namespace Renderer
 
 	} // bindTexture
 
+//////////////////////////////////////////////////////////////////////////
+
+	bool GLES20Renderer::readTexture(const unsigned int _texture, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+#if OPENGL_EXTENSIONS
+		if (glGenFramebuffers == nullptr || glFramebufferTexture2D == nullptr)
+			return false;
+#endif
+
+		// GLES has no glGetTexImage : attach the texture to a framebuffer, and read it
+		GLuint frameBuffer = 0;
+		GL_CHECK_ERROR(glGenFramebuffers(1, &frameBuffer));
+		if (frameBuffer == 0)
+			return false;
+
+		GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer));
+		GL_CHECK_ERROR(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture, 0));
+
+		glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, _data);
+		bool ret = glGetError() == GL_NO_ERROR;
+
+		GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GL_CHECK_ERROR(glDeleteFramebuffers(1, &frameBuffer));
+
+		return ret;
+
+	} // readTexture
+
 //////////////////////////////////////////////////////////////////////////
 
 	void GLES20Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
@@ -1148,6 +1170,13 @@ namespace Renderer
 		return customShader->supportsCornerRadius();
 	}
 
+	void GLES20Renderer::preloadShader(const std::string& path)
+	{
+		// Presets are resolved when they're used, only plain shaders can be read ahead
+		if (Utils::String::toLower(Utils::FileSystem::getExtension(path)) == ".glsl")
+			ShaderProgram::prefetch(path);
+	}
+
 	void GLES20Renderer::postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data)
 	{
 #if OPENGL_EXTENSIONS
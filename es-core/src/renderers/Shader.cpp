@@ -4,8 +4,14 @@
 #include "resources/ResourceManager.h"
 #include "utils/StringUtil.h"
 #include "utils/HtmlColor.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/TaskScheduler.h"
+#include "Paths.h"
 
 #include <set>
+#include <mutex>
+#include <memory>
+#include <cstring>
 
 namespace Renderer
 {
@@ -103,7 +109,7 @@ namespace Renderer
 		}
 	}
 
-	static std::string appendVersionAndType(const std::string& shaderCode, const std::string& customDefines)
+	static std::string appendVersionAndType(const std::string& shaderCode, const std::string& customDefines, const std::string& versionString = SHADER_VERSION_STRING)
 	{
 		auto pos = shaderCode.find("#version");
 		if (pos != std::string::npos)
@@ -116,37 +122,398 @@ namespace Renderer
 			}
 		}
 
-		return SHADER_VERSION_STRING + customDefines + "\n" + shaderCode;
+		return versionString + customDefines + "\n" + shaderCode;
 	}
 
-	bool ShaderProgram::loadFromFile(const std::string& path)
+	//////////////////////////////////////////////////////////////////////////
+	// Program binary cache
+	//
+	// Binaries are stored in <user es path>/cache/shaders/<driver hash>/<program hash>.bin, and kept in memory
+	// for the session : re-creating the context after a game doesn't compile nor read anything.
+	// Binaries are only valid for the driver that produced them, a driver update simply starts a new folder.
+
+	struct ProgramBinary
+	{
+		GLenum      format;
+		std::string data;
+	};
+
+	static const char    PROGRAM_BINARY_MAGIC[4] = { 'E', 'S', 'P', 'B' };
+
+	static std::mutex    _binaryLock;
+	static bool          _binaryCacheEnabled = false;
+	static std::string   _binaryCachePath;
+	static std::string   _binaryDriverKey;
+	static std::string   _binaryVersionString;  // SHADER_VERSION_STRING, readable from the workers
+	static std::map<unsigned long long, std::shared_ptr<ProgramBinary>> _programBinaries;
+
+	struct PrefetchedShader
+	{
+		PrefetchedShader() : ready(false) { }
+
+		bool        ready;
+		std::string code;
+	};
+
+	static std::mutex    _prefetchLock;
+	static std::map<std::string, PrefetchedShader> _prefetchedShaders;
+
+	static unsigned long long hashString(unsigned long long hash, const std::string& value)
+	{
+		// FNV-1a
+		for (unsigned char c : value)
+		{
+			hash ^= c;
+			hash *= 1099511628211ULL;
+		}
+
+		// Separator, so that "ab" + "c" and "a" + "bc" don't collide
+		hash ^= 0xFF;
+		hash *= 1099511628211ULL;
+		return hash;
+	}
+
+	static unsigned long long getProgramKey(const std::string& driverKey, const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		hash = hashString(hash, driverKey);
+		hash = hashString(hash, vertexSource);
+		hash = hashString(hash, fragmentSource);
+		return hash;
+	}
+
+	static std::string getProgramBinaryPath(const std::string& cachePath, unsigned long long key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", key);
+		return cachePath + "/" + name;
+	}
+
+	static std::shared_ptr<ProgramBinary> readProgramBinary(const std::string& path)
+	{
+		if (!Utils::FileSystem::exists(path))
+			return nullptr;
+
+		const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+		if (data.ptr == nullptr || data.length <= sizeof(PROGRAM_BINARY_MAGIC) + sizeof(unsigned int))
+			return nullptr;
+
+		const char* ptr = reinterpret_cast<const char*>(data.ptr.get());
+		if (memcmp(ptr, PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC)) != 0)
+			return nullptr;
+
+		ptr += sizeof(PROGRAM_BINARY_MAGIC);
+
+		unsigned int format = 0;
+		memcpy(&format, ptr, sizeof(unsigned int));
+		ptr += sizeof(unsigned int);
+
+		auto binary = std::make_shared<ProgramBinary>();
+		binary->format = (GLenum)format;
+		binary->data.assign(ptr, data.length - sizeof(PROGRAM_BINARY_MAGIC) - sizeof(unsigned int));
+		return binary;
+	}
+
+	static void writeProgramBinary(const std::string& path, const std::shared_ptr<ProgramBinary>& binary)
+	{
+		unsigned int format = (unsigned int)binary->format;
+
+		std::string content;
+		content.reserve(sizeof(PROGRAM_BINARY_MAGIC) + sizeof(unsigned int) + binary->data.size());
+		content.append(PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC));
+		content.append(reinterpret_cast<const char*>(&format), sizeof(unsigned int));
+		content.append(binary->data);
+
+		// Write aside and rename, a reader never sees a partial file
+		std::string tmpPath = path + ".tmp";
+		Utils::FileSystem::writeAllText(tmpPath, content);
+		Utils::FileSystem::renameFile(tmpPath, path);
+	}
+
+	// Returns the binary from the session cache, or from the disk
+	static std::shared_ptr<ProgramBinary> findProgramBinary(unsigned long long key)
+	{
+		std::string cachePath;
+
+		{
+			std::unique_lock<std::mutex> lock(_binaryLock);
+			if (!_binaryCacheEnabled)
+				return nullptr;
+
+			auto it = _programBinaries.find(key);
+			if (it != _programBinaries.cend())
+				return it->second;
+
+			cachePath = _binaryCachePath;
+		}
+
+		auto binary = readProgramBinary(getProgramBinaryPath(cachePath, key));
+		if (binary != nullptr)
+		{
+			std::unique_lock<std::mutex> lock(_binaryLock);
+			_programBinaries[key] = binary;
+		}
+
+		return binary;
+	}
+
+	void ShaderProgram::initializeBinaryCache()
 	{
-		if (!ResourceManager::getInstance()->fileExists(path))
+		std::string vendor = glGetString(GL_VENDOR) ? (const char*)glGetString(GL_VENDOR) : "";
+		std::string renderer = glGetString(GL_RENDERER) ? (const char*)glGetString(GL_RENDERER) : "";
+		std::string version = glGetString(GL_VERSION) ? (const char*)glGetString(GL_VERSION) : "";
+
+		std::string driverKey = vendor + "\n" + renderer + "\n" + version;
+
+		bool enabled = initializeProgramBinaryExtension();
+
+		// Software rasterizers gain nothing from it, and would only fill the cache with binaries of every Mesa build they run on
+		std::string lowRenderer = Utils::String::toLower(renderer);
+		if (lowRenderer.find("llvmpipe") != std::string::npos || lowRenderer.find("softpipe") != std::string::npos || lowRenderer.find("software rasterizer") != std::string::npos)
+			enabled = false;
+
+		char driverHash[32];
+		snprintf(driverHash, sizeof(driverHash), "%016llx", hashString(14695981039346656037ULL, driverKey));
+
+		std::string rootPath = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/shaders");
+		std::string cachePath = rootPath + "/" + driverHash;
+
+		if (enabled)
+		{
+			// Drop the binaries of other drivers
+			if (Utils::FileSystem::isDirectory(rootPath))
+				for (auto dir : Utils::FileSystem::getDirContent(rootPath))
+					if (dir != cachePath && Utils::FileSystem::isDirectory(dir))
+						Utils::FileSystem::deleteDirectoryFiles(dir, true);
+
+			enabled = Utils::FileSystem::createDirectory(cachePath);
+		}
+
+		LOG(LogInfo) << "GLSL program binary cache : " << (enabled ? cachePath : std::string("disabled"));
+
+		std::unique_lock<std::mutex> lock(_binaryLock);
+
+		if (_binaryDriverKey != driverKey)
+			_programBinaries.clear();
+
+		_binaryCacheEnabled = enabled;
+		_binaryCachePath = cachePath;
+		_binaryDriverKey = driverKey;
+		_binaryVersionString = SHADER_VERSION_STRING;
+	}
+
+	bool ShaderProgram::loadProgramBinary(unsigned long long key)
+	{
+		if (glProgramBinary_ == nullptr)
 			return false;
-		
-		// This will load the entire GLSL source code into the string variable.
-		const ResourceData& shaderData = ResourceManager::getInstance()->getFileData(path);
 
-		std::string shaderCode;
-		shaderCode.assign(reinterpret_cast<const char*>(shaderData.ptr.get()), shaderData.length);
+		auto binary = findProgramBinary(key);
+		if (binary == nullptr)
+			return false;
 
-		std::string versionString = SHADER_VERSION_STRING;
+		GLuint programId = glCreateProgram();
+		glProgramBinary_(programId, binary->format, binary->data.data(), (GLsizei)binary->data.size());
 
-		Shader vertex = Shader::createShader(GL_VERTEX_SHADER, appendVersionAndType(shaderCode, "#define VERTEX"));
-		if (!vertex.compileStatus)
+		// A binary can be rejected with an error, or with a failed link status : both mean recompiling
+		while (glGetError() != GL_NO_ERROR);
+
+		GLint isLinked = GL_FALSE;
+		GL_CHECK_ERROR(glGetProgramiv(programId, GL_LINK_STATUS, &isLinked));
+
+		if (isLinked != GL_TRUE)
 		{
-			LOG(LogError) << "Failed to compile GLSL VERTEX shader : " << path;
+			LOG(LogWarning) << "GLSL program binary rejected by the driver, recompiling";
+
+			GL_CHECK_ERROR(glDeleteProgram(programId));
+
+			std::unique_lock<std::mutex> lock(_binaryLock);
+			_programBinaries.erase(key);
+			Utils::FileSystem::removeFile(getProgramBinaryPath(_binaryCachePath, key));
 			return false;
 		}
 
-		Shader fragment = Shader::createShader(GL_FRAGMENT_SHADER, appendVersionAndType(shaderCode, "#define FRAGMENT"));
+		this->linkStatus = true;
+		this->mId = programId;
+		findAttribsAndUniforms();
+		return true;
+	}
+
+	void ShaderProgram::saveProgramBinary(unsigned long long key)
+	{
+		if (glGetProgramBinary_ == nullptr)
+			return;
+
+		GLint length = 0;
+		GL_CHECK_ERROR(glGetProgramiv(mId, GL_PROGRAM_BINARY_LENGTH, &length));
+		if (length <= 0)
+			return;
+
+		auto binary = std::make_shared<ProgramBinary>();
+		binary->format = 0;
+		binary->data.resize(length);
+
+		GLsizei written = 0;
+		glGetProgramBinary_(mId, length, &written, &binary->format, &binary->data[0]);
+
+		bool failed = false;
+		while (glGetError() != GL_NO_ERROR)
+			failed = true;
+
+		if (failed || written <= 0)
+			return;
+
+		binary->data.resize(written);
+
+		std::string path;
+
+		{
+			std::unique_lock<std::mutex> lock(_binaryLock);
+			if (!_binaryCacheEnabled)
+				return;
+
+			_programBinaries[key] = binary;
+			path = getProgramBinaryPath(_binaryCachePath, key);
+		}
+
+		Utils::TaskScheduler::run([path, binary] { writeProgramBinary(path, binary); });
+	}
+
+	bool ShaderProgram::createShaderProgram(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		unsigned long long key = 0;
+		bool useCache = false;
+
+		{
+			std::unique_lock<std::mutex> lock(_binaryLock);
+			if (_binaryCacheEnabled)
+			{
+				key = getProgramKey(_binaryDriverKey, vertexSource, fragmentSource);
+				useCache = true;
+			}
+		}
+
+		if (useCache && loadProgramBinary(key))
+			return true;
+
+		Shader vertex = Shader::createShader(GL_VERTEX_SHADER, vertexSource);
+		if (!vertex.compileStatus)
+			return false;
+
+		Shader fragment = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSource);
 		if (!fragment.compileStatus)
 		{
-			LOG(LogError) << "Failed to compile GLSL FRAGMENT shader : " << path;
+			vertex.deleteShader();
+			return false;
+		}
+
+		if (!createShaderProgram(vertex, fragment))
+			return false;
+
+		if (useCache)
+			saveProgramBinary(key);
+
+		return true;
+	}
+
+	void ShaderProgram::prefetch(const std::string& path)
+	{
+		if (path.empty())
+			return;
+
+		std::string fullPath = ResourceManager::getInstance()->getResourcePath(path);
+
+		{
+			std::unique_lock<std::mutex> lock(_prefetchLock);
+			if (_prefetchedShaders.find(fullPath) != _prefetchedShaders.cend())
+				return;
+
+			_prefetchedShaders[fullPath] = PrefetchedShader();
+		}
+
+		Utils::TaskScheduler::run([fullPath]
+		{
+			std::string shaderCode;
+
+			if (ResourceManager::getInstance()->fileExists(fullPath))
+			{
+				const ResourceData shaderData = ResourceManager::getInstance()->getFileData(fullPath);
+				if (shaderData.ptr != nullptr)
+					shaderCode.assign(reinterpret_cast<const char*>(shaderData.ptr.get()), shaderData.length);
+			}
+
+			// Once the context exists, bring the binary in memory too
+			std::string driverKey;
+			std::string versionString;
+
+			{
+				std::unique_lock<std::mutex> lock(_binaryLock);
+				if (_binaryCacheEnabled)
+				{
+					driverKey = _binaryDriverKey;
+					versionString = _binaryVersionString;
+				}
+			}
+
+			if (!shaderCode.empty() && !driverKey.empty())
+			{
+				auto vertexSource = appendVersionAndType(shaderCode, "#define VERTEX", versionString);
+				auto fragmentSource = appendVersionAndType(shaderCode, "#define FRAGMENT", versionString);
+				findProgramBinary(getProgramKey(driverKey, vertexSource, fragmentSource));
+			}
+
+			std::unique_lock<std::mutex> lock(_prefetchLock);
+
+			// Dropped if loadFromFile didn't wait for it
+			auto it = _prefetchedShaders.find(fullPath);
+			if (it != _prefetchedShaders.cend() && !it->second.ready)
+			{
+				it->second.code = shaderCode;
+				it->second.ready = true;
+			}
+		});
+	}
+
+	bool ShaderProgram::loadFromFile(const std::string& path)
+	{
+		std::string shaderCode;
+		bool prefetched = false;
+
+		{
+			std::string fullPath = ResourceManager::getInstance()->getResourcePath(path);
+
+			std::unique_lock<std::mutex> lock(_prefetchLock);
+
+			auto it = _prefetchedShaders.find(fullPath);
+			if (it != _prefetchedShaders.cend())
+			{
+				prefetched = it->second.ready && !it->second.code.empty();
+				if (prefetched)
+					shaderCode = it->second.code;
+
+				_prefetchedShaders.erase(it);
+			}
+		}
+
+		if (!prefetched)
+		{
+			if (!ResourceManager::getInstance()->fileExists(path))
+				return false;
+
+			// This will load the entire GLSL source code into the string variable.
+			const ResourceData& shaderData = ResourceManager::getInstance()->getFileData(path);
+			shaderCode.assign(reinterpret_cast<const char*>(shaderData.ptr.get()), shaderData.length);
+		}
+
+		std::string vertexSource = appendVersionAndType(shaderCode, "#define VERTEX");
+		std::string fragmentSource = appendVersionAndType(shaderCode, "#define FRAGMENT");
+
+		if (!createShaderProgram(vertexSource, fragmentSource))
+		{
+			LOG(LogError) << "Failed to create GLSL program : " << path;
 			return false;
 		}
 
-		return createShaderProgram(vertex, fragment);
+		return true;
 	}
 
 	bool ShaderProgram::createShaderProgram(Shader &vertexShader, Shader &fragmentShader)
@@ -39,9 +39,18 @@ namespace Renderer
 
 		bool loadFromFile(const std::string& path);
 
+		// Builds the program from its sources, or from the program binary cached for them if any
+		bool createShaderProgram(const std::string& vertexSource, const std::string& fragmentSource);
+
 		// Links vertex and fragment shaders together to make a GLSL program
 		bool createShaderProgram(Shader &vertexShader, Shader &fragmentShader);
 
+		// Enables the on-disk program binary cache if the driver supports it. Must be called once the context is created
+		static void initializeBinaryCache();
+
+		// Reads a shader file, and its cached program binary, on a worker thread. loadFromFile will use them
+		static void prefetch(const std::string& path);
+
 		void select();
 		void unSelect();
 
@@ -93,6 +102,9 @@ namespace Renderer
 
 	private:
 		void findAttribsAndUniforms();
+
+		bool loadProgramBinary(unsigned long long key);
+		void saveProgramBinary(unsigned long long key);
 	};
 
 } // Renderer::
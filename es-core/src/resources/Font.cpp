@@ -12,6 +12,7 @@
 #include "Settings.h"
 #include "ImageIO.h"
 #include <algorithm>
+#include <set>
 #include "math/Transform4x4f.h"
 
 #ifdef WIN32
@@ -69,16 +70,25 @@ size_t Font::getTotalMemUsage()
 {
 	size_t total = 0;
 
+	// Face data is shared between sizes : count it once
+	std::set<const unsigned char*> faceData;
+
 	auto it = sFontMap.cbegin();
 	while(it != sFontMap.cend())
 	{
-		if(it->second.expired())
+		auto font = it->second.lock();
+		if (font == nullptr)
 		{
 			it = sFontMap.erase(it);
 			continue;
 		}
 
-		total += it->second.lock()->getMemUsage();
+		total += font->getMemUsage();
+
+		for (auto face = font->mFaceCache.cbegin(); face != font->mFaceCache.cend(); face++)
+			if (!faceData.insert(face->second->data.ptr.get()).second)
+				total -= face->second->data.length;
+
 		it++;
 	}
 
@@ -292,10 +302,6 @@ std::vector<std::string> getFallbackFontPaths()
 	return paths;
 }
 
-#if defined(WIN32) || defined(X86) || defined(X86_64)
-static std::map<std::string, ResourceData> globalTTFCache;
-#endif
-
 FT_Face Font::getFaceForChar(unsigned int id)
 {
 	static const std::vector<std::string> fallbackFonts = getFallbackFontPaths();
@@ -311,23 +317,12 @@ FT_Face Font::getFaceForChar(unsigned int id)
 			// otherwise, take from fallbackFonts
 			const std::string& path = (i == 0 ? mPath : fallbackFonts.at(i - 1));
 
-#if defined(WIN32) || defined(X86) || defined(X86_64)
-			auto itCache = globalTTFCache.find(path);
-			if (itCache == globalTTFCache.cend())
-			{
-				ResourceData dataX = ResourceManager::getInstance()->getFileData(path);
-				globalTTFCache.insert(std::pair<std::string, ResourceData>(path, dataX));
-				itCache = globalTTFCache.find(path);
-			}
-						
-			if (itCache == globalTTFCache.cend())
+			// Faces of all sizes share the same file data
+			ResourceData data = ResourceManager::getInstance()->getSharedFileData(path);
+			if (data.ptr == nullptr)
 				continue;
 
-			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(itCache->second), mSize));
-#else
-			ResourceData data = ResourceManager::getInstance()->getFileData(path);
 			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(data), mSize));
-#endif
 			fit = mFaceCache.find(i);
 		}
 
@@ -9,6 +9,7 @@
 #include "Paths.h"
 #include "utils/ConcurrentVector.h"
 #include <unordered_map>
+#include <mutex>
 
 auto array_deleter = [](unsigned char* p) { delete[] p; };
 
@@ -159,6 +160,53 @@ ResourceData ResourceManager::loadFile(const std::string& path, size_t size) con
 	return ret;
 }
 
+struct SharedFileData
+{
+	std::weak_ptr<unsigned char> ptr;
+	size_t length;
+};
+
+static std::mutex                                      _sharedFilesLock;
+static std::unordered_map<std::string, SharedFileData> _sharedFiles;
+
+const ResourceData ResourceManager::getSharedFileData(const std::string& path) const
+{
+	const std::string respath = getResourcePath(path);
+
+	std::unique_lock<std::mutex> lock(_sharedFilesLock);
+
+	auto it = _sharedFiles.find(respath);
+	if (it != _sharedFiles.cend())
+	{
+		auto ptr = it->second.ptr.lock();
+		if (ptr != nullptr)
+		{
+			ResourceData ret = { ptr, it->second.length };
+			return ret;
+		}
+
+		_sharedFiles.erase(it);
+	}
+
+	auto size = Utils::FileSystem::getFileSize(respath);
+	if (size == 0)
+	{
+		ResourceData data = { NULL, 0 };
+		return data;
+	}
+
+	// A private heap copy : themes installers rewrite font files in place, which a mapping would not survive
+	std::shared_ptr<unsigned char> ptr = loadFile(respath, (size_t)size).ptr;
+
+	SharedFileData shared;
+	shared.ptr = ptr;
+	shared.length = (size_t)size;
+	_sharedFiles[respath] = shared;
+
+	ResourceData ret = { ptr, (size_t)size };
+	return ret;
+}
+
 bool ResourceManager::fileExists(const std::string& path) const
 {
 	// Animated Gifs : Check if the extension contains a ',' -> If it's the case, we have the multi-image index as argument
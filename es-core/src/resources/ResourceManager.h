@@ -41,6 +41,9 @@ public:
 	std::vector<std::string> getResourcePaths() const;
 
 	const ResourceData getFileData(const std::string& path) const;
+
+	// Read-only data shared by all callers while it's referenced : one heap copy per file.
+	const ResourceData getSharedFileData(const std::string& path) const;
 	bool fileExists(const std::string& path) const;
 
 private:
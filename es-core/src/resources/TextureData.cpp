@@ -440,6 +440,9 @@ bool TextureData::load(bool updateCache)
 	if (mPath.empty())
 		return false;
 
+	if (loadFromSnapshot())
+		return true;
+
 	LOG(LogDebug) << "TextureData::load " << mPath;
 	mScalable = false;
 
@@ -540,6 +543,77 @@ void TextureData::releaseRAM()
 	mDataRGBA = 0;
 }
 
+unsigned char* TextureData::readVRAM(Vector2i& size)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if (mTextureID == 0 || mSize.empty())
+		return nullptr;
+
+	unsigned char* dataRGBA = new unsigned char[mSize.x() * mSize.y() * 4];
+	if (!Renderer::readTexture(mTextureID, mSize.x(), mSize.y(), dataRGBA))
+	{
+		delete[] dataRGBA;
+		return nullptr;
+	}
+
+	size = mSize;
+	return dataRGBA;
+}
+
+void TextureData::setSnapshot(unsigned char* dataRGBA, const Vector2i& size)
+{
+	std::vector<unsigned char> snapshot;
+	Utils::Zip::ZipFile::compressBuffer(dataRGBA, size.x() * size.y() * 4, snapshot);
+	delete[] dataRGBA;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mSnapshot = std::move(snapshot);
+	mSnapshotSize = size;
+}
+
+void TextureData::releaseSnapshot()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	std::vector<unsigned char>().swap(mSnapshot);
+}
+
+bool TextureData::hasSnapshot()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return !mSnapshot.empty();
+}
+
+bool TextureData::loadFromSnapshot()
+{
+	std::vector<unsigned char> snapshot;
+	size_t width, height;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mSnapshot.empty())
+			return false;
+
+		snapshot.swap(mSnapshot);
+
+		if (mDataRGBA != nullptr || mTextureID != 0)
+			return false;
+
+		// mSize may have changed since ( max size of a new theme ) : the snapshot has its own
+		width = mSnapshotSize.x();
+		height = mSnapshotSize.y();
+	}
+
+	unsigned char* dataRGBA = new unsigned char[width * height * 4];
+	if (!Utils::Zip::ZipFile::uncompressBuffer(snapshot.data(), snapshot.size(), dataRGBA, width * height * 4))
+	{
+		delete[] dataRGBA;
+		return false;
+	}
+
+	return initFromRGBA(dataRGBA, width, height, false);
+}
+
 void TextureData::setStoredSize(float width, float height)
 {
 	mSize = Vector2i(width, height);
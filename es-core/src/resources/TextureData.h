@@ -50,6 +50,13 @@ public:
 	// Release the texture from conventional RAM
 	void releaseRAM();
 
+	// Snapshot kept in RAM while a game runs : load() restores it instead of decoding the file again.
+	// readVRAM must be called from the render thread, setSnapshot compresses and can run on any thread
+	unsigned char* readVRAM(Vector2i& size);
+	void setSnapshot(unsigned char* dataRGBA, const Vector2i& size);
+	void releaseSnapshot();
+	bool hasSnapshot();
+
 	// Get the amount of VRAM currenty used by this texture
 	inline size_t getEstimatedVRAMUsage() { return mSize.x() * mSize.y() * 4; }
 	inline size_t getVRAMUsage() { return mTextureID != 0 || mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0; }
@@ -119,6 +126,11 @@ private:
 */
 
 	bool			mIsExternalDataRGBA;
+
+	bool loadFromSnapshot();
+
+	std::vector<unsigned char> mSnapshot; // zlib compressed RGBA
+	Vector2i                   mSnapshotSize;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
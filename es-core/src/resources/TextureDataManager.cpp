@@ -4,6 +4,7 @@
 #include "resources/TextureResource.h"
 #include "Settings.h"
 #include "Log.h"
+#include "utils/TaskScheduler.h"
 #include <algorithm>
 #include <SDL.h>
 
@@ -58,8 +59,8 @@ void TextureDataManager::cancelAsync(const TextureResource* key)
 	std::unique_lock<std::recursive_mutex> lock(mMutex);
 
 	auto it = mTextureLookup.find(key);
-	if (it != mTextureLookup.cend())
-		mLoader->remove(*(*it).second);
+	if (it != mTextureLookup.cend() && mLoader->remove(*(*it).second))
+		(*(*it).second)->releaseSnapshot(); // Would have been restored by the load that's cancelled
 }
 
 std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key, TextureLoadMode enableLoading)
@@ -137,6 +138,17 @@ size_t TextureDataManager::getQueueSize()
 	return mLoader->getQueueSize();
 }
 
+bool TextureDataManager::isQueued(std::shared_ptr<TextureData> tex)
+{
+	return mLoader != nullptr && mLoader->isQueued(tex);
+}
+
+std::vector<std::shared_ptr<TextureData>> TextureDataManager::getTextures()
+{
+	std::unique_lock<std::recursive_mutex> lock(mMutex);
+	return std::vector<std::shared_ptr<TextureData>>(mTextures.cbegin(), mTextures.cend());
+}
+
 bool compareTextures(const std::shared_ptr<TextureData>& first, const std::shared_ptr<TextureData>& second)
 {
 	bool isResource = first->getPath().rfind(":/") == 0;
@@ -248,14 +260,11 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 		tex->load();
 }
 
-TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false)
+TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false), mRunningTasks(0)
 {
-	int num_threads = std::thread::hardware_concurrency() / 2;
-	if (num_threads == 0)
-		num_threads = 1;
-
-	for (size_t i = 0; i < num_threads; i++)
-		mThreads.push_back(std::thread(&TextureLoader::threadProc, this));
+	mMaxTasks = std::thread::hardware_concurrency() / 2;
+	if (mMaxTasks == 0)
+		mMaxTasks = 1;
 }
 
 TextureLoader::~TextureLoader()
@@ -263,51 +272,37 @@ TextureLoader::~TextureLoader()
 	// Just abort any waiting texture
 	clearQueue();
 
-	// Exit the thread
+	// Wait for the textures being loaded
+	std::unique_lock<std::mutex> lock(mLoaderLock);
 	mExit = true;
-	mEvent.notify_all();
-
-	for (std::thread& t : mThreads)
-		t.join();
+	mEvent.wait(lock, [this]() { return mRunningTasks == 0; });
 }
 
-void TextureLoader::threadProc()
+void TextureLoader::processQueue()
 {
-	while (true)
-	{		
-		// Wait for an event to say there is something in the queue
-		std::unique_lock<std::mutex> lock(mLoaderLock);
-		mEvent.wait(lock, [this]() { return !paused && (mExit || !mTextureDataQ.empty()); });
+	std::unique_lock<std::mutex> lock(mLoaderLock);
 
-		if (mExit)
-			break;
+	while (!mExit && !paused && !mTextureDataQ.empty())
+	{
+		std::shared_ptr<TextureData> textureData = mTextureDataQ.front();
 
-		if (!mTextureDataQ.empty())
-		{
-			std::shared_ptr<TextureData> textureData = mTextureDataQ.front();
-
-			mTextureDataQ.pop_front();
-			mTextureDataQSet.erase(textureData);
-
-			if (textureData && !textureData->isLoaded())
-			{
-				mProcessingTextureDataQ.insert(textureData);
-				
-				lock.unlock();
-				std::this_thread::yield();
-				
-				textureData->load(true);
-				
-				std::this_thread::yield();
-				lock.lock();
-
-				mProcessingTextureDataQ.erase(textureData);
-			}
+		mTextureDataQ.pop_front();
+		mTextureDataQSet.erase(textureData);
 
+		if (textureData && !textureData->isLoaded())
+		{
+			mProcessingTextureDataQ.insert(textureData);
+			
 			lock.unlock();
-			std::this_thread::yield();
-		}		
+			textureData->load(true);
+			lock.lock();
+
+			mProcessingTextureDataQ.erase(textureData);
+		}
 	}
+
+	mRunningTasks--;
+	mEvent.notify_all();
 }
 
 bool TextureLoader::paused = false;
@@ -339,7 +334,14 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 	mTextureDataQ.push_front(textureData);
 	mTextureDataQSet.insert(textureData);
 
-	mEvent.notify_one();
+	// While paused, textures stay queued until the next load request
+	if (paused || mExit || mRunningTasks >= mMaxTasks)
+		return;
+
+	mRunningTasks++;
+	lock.unlock();
+
+	Utils::TaskScheduler::run([this]() { processQueue(); }, Utils::TaskScheduler::UI_CRITICAL);
 }
 
 bool TextureLoader::remove(std::shared_ptr<TextureData> textureData)
@@ -359,6 +361,12 @@ bool TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 	return false;
 }
 
+bool TextureLoader::isQueued(std::shared_ptr<TextureData> textureData)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+	return mTextureDataQSet.find(textureData) != mTextureDataQSet.cend() || mProcessingTextureDataQ.find(textureData) != mProcessingTextureDataQ.cend();
+}
+
 size_t TextureLoader::getQueueSize()
 {
 	std::unique_lock<std::mutex> lock(mLoaderLock);
@@ -378,11 +386,19 @@ size_t TextureLoader::getQueueSize()
 
 void TextureLoader::clearQueue()
 {
-	std::unique_lock<std::mutex> lock(mLoaderLock);
+	std::list<std::shared_ptr<TextureData>> aborted;
 
-	// Just abort any waiting texture
-	mTextureDataQSet.clear();
-	mTextureDataQ.clear();	
+	{
+		std::unique_lock<std::mutex> lock(mLoaderLock);
+
+		// Just abort any waiting texture
+		mTextureDataQSet.clear();
+		mTextureDataQ.swap(aborted);
+	}
+
+	// Snapshots kept while a game ran were waiting for these loads
+	for (auto tex : aborted)
+		tex->releaseSnapshot();
 }
 
 void TextureDataManager::clearQueue()
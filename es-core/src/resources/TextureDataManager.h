@@ -24,6 +24,7 @@ public:
 
 	void load(std::shared_ptr<TextureData> textureData);
 	bool remove(std::shared_ptr<TextureData> textureData);
+	bool isQueued(std::shared_ptr<TextureData> textureData);
 	void clearQueue();
 
 	size_t getQueueSize();
@@ -33,13 +34,15 @@ public:
 	std::mutex& Mutex() { return mLoaderLock; }
 
 private:	
-	void threadProc();
+	// Loads queued textures until the queue is empty. Runs on the TaskScheduler, at most mMaxTasks at once
+	void processQueue();
 
 	std::set<std::shared_ptr<TextureData>> 											mProcessingTextureDataQ;
 	std::list<std::shared_ptr<TextureData>> 										mTextureDataQ;
 	std::set<std::shared_ptr<TextureData>> 											mTextureDataQSet;
 
-	std::vector<std::thread>	mThreads;
+	int							mRunningTasks;
+	int							mMaxTasks;
 	std::mutex					mLoaderLock;
 	std::condition_variable		mEvent;
 	bool 						mExit;
@@ -93,6 +96,10 @@ public:
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
+	// Is the texture waiting to be loaded or being loaded
+	bool	isQueued(std::shared_ptr<TextureData> tex);
+	// Get the managed textures, most recently used first
+	std::vector<std::shared_ptr<TextureData>> getTextures();
 	// Load a texture, freeing resources as necessary to make space
 	void load(std::shared_ptr<TextureData> tex, bool block = false);
 
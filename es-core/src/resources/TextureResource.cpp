@@ -7,10 +7,13 @@
 #include "PowerSaver.h"
 #include "Log.h"
 #include "renderers/Renderer.h"
+#include "utils/TaskScheduler.h"
 
 TextureDataManager		TextureResource::sTextureDataManager;
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
 std::set<TextureResource*> 	TextureResource::sNonDynamicTextureResources;
+bool						TextureResource::sSuspended = false;
+bool						TextureResource::sSnapshotsHeld = false;
 
 TextureResource::TextureResource(const std::string& path, bool tile, bool linear, bool dynamic, bool allowAsync, const MaxSizeInfo* maxSize) : mTextureData(nullptr), mForceLoad(false)
 {
@@ -361,11 +364,19 @@ bool TextureResource::unload()
 		return true;
 	}
 
-	return false;
+	// Not loaded by the held reload : the next one restores the copy
+	return sSnapshotsHeld && data != nullptr && data->hasSnapshot();
 }
 
 void TextureResource::reload()
 {
+	if (sSnapshotsHeld)
+	{
+		auto data = mTextureData ? mTextureData : sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::DISABLED);
+		if (data != nullptr && data->hasSnapshot())
+			return;
+	}
+
 	// For dynamically loaded textures the texture manager will load them on demand.
 	// For manually loaded textures we have to reload them here
 	if (mTextureData)
@@ -374,7 +385,96 @@ void TextureResource::reload()
 			mTextureData->load();
 	}
 	else
-		sTextureDataManager.get(this);
+	{
+		auto data = sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::DISABLED);
+		if (data != nullptr && (!sSuspended || data->hasSnapshot()))
+			sTextureDataManager.get(this);
+	}
+}
+
+void TextureResource::suspend(size_t maxSize)
+{
+	if (maxSize == 0)
+		return;
+
+	StopWatch stopWatch("TextureResource::suspend", LogDebug);
+
+	std::vector<std::shared_ptr<TextureData>> textures;
+
+	// Textures that manage their own data are reloaded synchronously : they come first
+	for (auto tex : sNonDynamicTextureResources)
+		if (tex->mTextureData != nullptr)
+			textures.push_back(tex->mTextureData);
+
+	for (auto tex : sTextureDataManager.getTextures())
+		textures.push_back(tex);
+
+	Utils::TaskGroup compression(0, Utils::TaskScheduler::INTERACTIVE);
+
+	size_t total = 0;
+	int count = 0;
+
+	for (auto tex : textures)
+	{
+		tex->releaseSnapshot();
+
+		if (!tex->isReloadable())
+			continue;
+
+		size_t size = tex->getEstimatedVRAMUsage();
+		if (size == 0 || total + size > maxSize)
+			continue;
+
+		Vector2i snapshotSize;
+		unsigned char* dataRGBA = tex->readVRAM(snapshotSize);
+		if (dataRGBA == nullptr)
+			continue;
+
+		compression.run([tex, dataRGBA, snapshotSize] { tex->setSnapshot(dataRGBA, snapshotSize); });
+
+		total += size;
+		count++;
+	}
+
+	compression.wait();
+
+	sSuspended = count > 0;
+
+	LOG(LogInfo) << "TextureResource::suspend : " << count << " textures (" << (total / 1024) << " KB) kept in RAM";
+}
+
+void TextureResource::resume()
+{
+	sSuspended = false;
+
+	// Snapshots are consumed by the reload. Those of textures that were not reloaded, and are not waiting to be, are freed now
+	int released = 0;
+
+	for (auto tex : sNonDynamicTextureResources)
+	{
+		if (tex->mTextureData != nullptr && tex->mTextureData->hasSnapshot())
+		{
+			tex->mTextureData->releaseSnapshot();
+			released++;
+		}
+	}
+
+	for (auto tex : sTextureDataManager.getTextures())
+	{
+		if (tex->hasSnapshot() && !sTextureDataManager.isQueued(tex))
+		{
+			tex->releaseSnapshot();
+			released++;
+		}
+	}
+
+	if (released > 0)
+		LOG(LogDebug) << "TextureResource::resume : " << released << " unused snapshots released";
+}
+
+void TextureResource::holdSnapshots(bool hold)
+{
+	sSnapshotsHeld = hold;
 }
 
 void TextureResource::clearQueue()
@@ -53,6 +53,14 @@ public:
 
 	static void clearQueue();
 
+	// Before launching a game : keeps a compressed copy of the textures in use, up to maxSize bytes of RGBA.
+	// Until resume is called, reloading restores these textures at once, and leaves the others to be loaded when drawn
+	static void suspend(size_t maxSize);
+	// After the reload : frees the copies that no pending load will use
+	static void resume();
+	// While held, reloading leaves the textures with a copy unloaded, and still to be reloaded : for a reload that precedes a new renderer
+	static void holdSnapshots(bool hold);
+
 private:
 	// mTextureData is used for textures that are not loaded from a file - these ones
 	// are permanently allocated and cannot be loaded and unloaded based on resources
@@ -68,6 +76,8 @@ private:
 	typedef std::tuple<std::string, bool, bool, std::string> TextureKeyType;
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
 	static std::set<TextureResource*> 	sNonDynamicTextureResources;
+	static bool							sSuspended;
+	static bool							sSnapshotsHeld;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_RESOURCE_H
@@ -707,6 +707,64 @@ namespace Utils
 			}
 		}
 
+		// Binary key ordering strings like compareIgnoreCase : each upper-cased code point is stored as 3 big endian bytes, so keys compare with memcmp.
+		// With naturalNumbers, a run of digits is stored as '0', its length, then its digits : "9" comes before "10"
+		std::string collationKey(const std::string& _string, bool naturalNumbers)
+		{
+			std::string key;
+			key.reserve(_string.size() * 3);
+
+			auto append = [&key](unsigned int code)
+			{
+				key.push_back((char)((code >> 16) & 0xFF));
+				key.push_back((char)((code >> 8) & 0xFF));
+				key.push_back((char)(code & 0xFF));
+			};
+
+			size_t cursor = 0;
+			while (cursor < _string.size())
+			{
+				char c = _string[cursor];
+
+				if (naturalNumbers && c >= '0' && c <= '9')
+				{
+					while (cursor < _string.size() && _string[cursor] == '0')
+						cursor++;
+
+					size_t digits = cursor;
+					while (cursor < _string.size() && _string[cursor] >= '0' && _string[cursor] <= '9')
+						cursor++;
+
+					append('0');
+					append((unsigned int)(cursor - digits) + 1);
+
+					if (cursor == digits) // Only zeroes
+						append('0');
+					else
+						for (size_t i = digits; i < cursor; i++)
+							append((unsigned char)_string[i]);
+
+					continue;
+				}
+
+				unsigned int code;
+				if ((c & 0x80) == 0)
+				{
+					code = (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+					cursor++;
+				}
+				else
+					code = toupperUnicode(chars2Unicode(_string, cursor));
+
+				if (code == 0)
+					break;
+
+				append(code);
+			}
+
+			return key;
+		}
+
 		bool containsIgnoreCase(const std::string & _string, const std::string & _what)
 		{
 			auto it = std::search(
@@ -0,0 +1,396 @@
+#include "utils/TaskScheduler.h"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace Utils
+{
+	struct TaskWorker
+	{
+		std::mutex                      lock;
+		std::deque<TaskScheduler::Task> queues[TaskScheduler::PRIORITY_COUNT];
+	};
+
+	// Never destroyed : exit() without stop() ( signal handlers ) would destroy them under the feet of waiting workers
+	static std::vector<TaskWorker*>&  _workers = *new std::vector<TaskWorker*>();
+	static std::vector<std::thread*>& _threads = *new std::vector<std::thread*>();
+	static std::mutex&                _lock = *new std::mutex(); // Protects start/stop, and pairs with _event
+	static std::condition_variable&   _event = *new std::condition_variable();
+	static std::condition_variable&   _criticalEvent = *new std::condition_variable();
+	static std::atomic<int>           _pending(0);
+	static std::atomic<int>           _pendingCritical(0);
+	static std::atomic<unsigned int>  _nextWorker(0);
+	static bool                       _started = false;
+	static bool                       _exit = false;
+
+	static std::mutex&                _dispatcherLock = *new std::mutex();
+	static std::function<void(const TaskScheduler::Task&)>& _uiDispatcher = *new std::function<void(const TaskScheduler::Task&)>();
+
+	static thread_local int          _workerIndex = -1;
+
+	// This worker only runs UI_CRITICAL tasks : blocking INTERACTIVE or BACKGROUND work ( scripts, pdf rendering, file probes ) can't hold back texture loading
+	#define RESERVED_WORKER 0
+
+	static TaskScheduler::Priority lowestPriorityOf(int worker)
+	{
+		return worker == RESERVED_WORKER ? TaskScheduler::UI_CRITICAL : TaskScheduler::BACKGROUND;
+	}
+
+	static void runSafe(const TaskScheduler::Task& task)
+	{
+		try
+		{
+			task();
+		}
+		catch (...) {}
+	}
+
+	void TaskScheduler::start()
+	{
+		int count = std::thread::hardware_concurrency();
+		if (count < 2)
+			count = 2;
+
+		// One per core, plus the reserved worker
+		count++;
+
+		for (int i = 0; i < count; i++)
+			_workers.push_back(new TaskWorker());
+
+		for (int i = 0; i < count; i++)
+			_threads.push_back(new std::thread(&TaskScheduler::workerProc, i));
+
+		_started = true;
+	}
+
+	int TaskScheduler::getWorkerCount()
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+
+		if (!_started && !_exit)
+			start();
+
+		// Once stopped, tasks run inline on the calling thread
+		if (_workers.size() == 0)
+			return 1;
+
+		// Workers running tasks of any priority
+		return (int)_workers.size() - 1;
+	}
+
+	bool TaskScheduler::isStopped()
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		return _exit;
+	}
+
+	bool TaskScheduler::isWorkerThread()
+	{
+		return _workerIndex >= 0;
+	}
+
+	void TaskScheduler::run(const Task& task, Priority priority)
+	{
+		int worker = _workerIndex;
+
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+
+			if (_exit)
+			{
+				lock.unlock();
+				runSafe(task);
+				return;
+			}
+
+			if (!_started)
+				start();
+
+			// From a worker, keep the task local : it's the most likely to be hot in cache
+			if (worker < 0)
+				worker = (int)(_nextWorker++ % _workers.size());
+
+			{
+				std::unique_lock<std::mutex> workerLock(_workers[worker]->lock);
+				_workers[worker]->queues[priority].push_back(task);
+			}
+
+			_pending++;
+
+			if (priority == UI_CRITICAL)
+				_pendingCritical++;
+		}
+
+		_event.notify_one();
+
+		if (priority == UI_CRITICAL)
+			_criticalEvent.notify_one();
+	}
+
+	void TaskScheduler::run(const Task& task, const Task& continuation, Priority priority)
+	{
+		run([task, continuation]
+		{
+			runSafe(task);
+
+			std::function<void(const Task&)> dispatcher;
+
+			{
+				std::unique_lock<std::mutex> lock(_dispatcherLock);
+				dispatcher = _uiDispatcher;
+			}
+
+			if (dispatcher)
+				dispatcher(continuation);
+			else
+				runSafe(continuation);
+		}, priority);
+	}
+
+	void TaskScheduler::setUiDispatcher(const std::function<void(const Task&)>& dispatcher)
+	{
+		std::unique_lock<std::mutex> lock(_dispatcherLock);
+		_uiDispatcher = dispatcher;
+	}
+
+	static void onPopped(int priority)
+	{
+		_pending--;
+
+		if (priority == TaskScheduler::UI_CRITICAL)
+			_pendingCritical--;
+	}
+
+	bool TaskScheduler::pop(int worker, Task& task)
+	{
+		int count = (int)_workers.size();
+
+		for (int priority = 0; priority <= lowestPriorityOf(worker); priority++)
+		{
+			if (worker >= 0)
+			{
+				TaskWorker* own = _workers[worker];
+
+				std::unique_lock<std::mutex> lock(own->lock);
+				if (!own->queues[priority].empty())
+				{
+					task = own->queues[priority].back();
+					own->queues[priority].pop_back();
+					onPopped(priority);
+					return true;
+				}
+			}
+
+			// Steal the oldest task of another worker
+			for (int i = 1; i <= count; i++)
+			{
+				int victim = ((worker < 0 ? 0 : worker) + i) % count;
+				if (victim == worker)
+					continue;
+
+				TaskWorker* other = _workers[victim];
+
+				std::unique_lock<std::mutex> lock(other->lock);
+				if (!other->queues[priority].empty())
+				{
+					task = other->queues[priority].front();
+					other->queues[priority].pop_front();
+					onPopped(priority);
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool TaskScheduler::runPending()
+	{
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			if (!_started || _pending == 0)
+				return false;
+		}
+
+		Task task;
+		if (!pop(_workerIndex, task))
+			return false;
+
+		runSafe(task);
+		return true;
+	}
+
+	void TaskScheduler::workerProc(int worker)
+	{
+		_workerIndex = worker;
+
+		while (true)
+		{
+			Task task;
+			if (pop(worker, task))
+			{
+				runSafe(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_lock);
+
+			if (worker == RESERVED_WORKER)
+			{
+				_criticalEvent.wait(lock, []() { return _exit || _pendingCritical > 0; });
+
+				if (_exit && _pendingCritical == 0)
+					break;
+
+				continue;
+			}
+
+			_event.wait(lock, []() { return _exit || _pending > 0; });
+
+			if (_exit && _pending == 0)
+				break;
+		}
+	}
+
+	void TaskScheduler::stop()
+	{
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			if (!_started)
+				return;
+
+			_exit = true;
+		}
+
+		_event.notify_all();
+		_criticalEvent.notify_all();
+
+		for (auto thread : _threads)
+		{
+			thread->join();
+			delete thread;
+		}
+
+		for (auto worker : _workers)
+			delete worker;
+
+		_threads.clear();
+		_workers.clear();
+		_started = false;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////
+
+	TaskGroup::TaskGroup(int maxConcurrency, TaskScheduler::Priority priority)
+		: mPriority(priority), mMaxConcurrency(maxConcurrency), mScheduled(0), mActive(0), mOutstanding(0)
+	{
+		if (mMaxConcurrency <= 0)
+			mMaxConcurrency = TaskScheduler::getWorkerCount();
+
+		if (mMaxConcurrency < 1)
+			mMaxConcurrency = 1;
+	}
+
+	TaskGroup::~TaskGroup()
+	{
+		wait();
+
+		// Drain tasks still queued in the scheduler reference the group
+		std::unique_lock<std::mutex> lock(mLock);
+		mEvent.wait(lock, [this]() { return mScheduled == 0; });
+	}
+
+	void TaskGroup::run(const TaskScheduler::Task& task)
+	{
+		if (TaskScheduler::isStopped())
+		{
+			// No worker left to run it, and nobody may wait for the group
+			runSafe(task);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+		mQueue.push_back(task);
+		mOutstanding++;
+
+		if (mScheduled + mActive >= mMaxConcurrency || mScheduled >= (int)mQueue.size())
+			return;
+
+		mScheduled++;
+		lock.unlock();
+
+		TaskScheduler::run([this]() { drain(); }, mPriority);
+	}
+
+	bool TaskGroup::runNext(std::unique_lock<std::mutex>& lock)
+	{
+		if (mQueue.empty() || mActive >= mMaxConcurrency)
+			return false;
+
+		auto task = mQueue.front();
+		mQueue.pop_front();
+		mActive++;
+
+		lock.unlock();
+		runSafe(task);
+		lock.lock();
+
+		mActive--;
+		mOutstanding--;
+		mEvent.notify_all();
+		return true;
+	}
+
+	void TaskGroup::drain()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mScheduled--;
+
+		while (runNext(lock));
+
+		mEvent.notify_all();
+	}
+
+	void TaskGroup::wait()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		while (mOutstanding > 0)
+			if (!runNext(lock))
+				mEvent.wait(lock);
+	}
+
+	void TaskGroup::wait(const TaskScheduler::Task& onIdle, int delay)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		// Don't help here : the caller wants onIdle to be called regularly
+		while (mOutstanding > 0)
+		{
+			lock.unlock();
+			onIdle();
+			lock.lock();
+
+			if (mOutstanding > 0)
+				mEvent.wait_for(lock, std::chrono::milliseconds(delay));
+		}
+	}
+
+	void TaskGroup::cancel()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		mOutstanding -= (int)mQueue.size();
+		mQueue.clear();
+
+		mEvent.notify_all();
+	}
+
+	bool TaskGroup::isIdle()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		return mOutstanding == 0;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef ES_CORE_UTILS_TASKSCHEDULER_H
+#define ES_CORE_UTILS_TASKSCHEDULER_H
+
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace Utils
+{
+	// Process-wide pool of one worker per core. Each worker owns a deque per priority : it pops its own tasks LIFO,
+	// and steals the oldest tasks of the other workers when it runs out. Idle workers sleep on a condition variable.
+	// An extra worker is reserved to UI_CRITICAL tasks, so blocking work of a lower priority can't starve them.
+	class TaskScheduler
+	{
+	public:
+		enum Priority : int
+		{
+			UI_CRITICAL = 0, // Something is displayed as soon as it's done
+			INTERACTIVE = 1, // The user is waiting for it
+			BACKGROUND = 2,
+
+			PRIORITY_COUNT = 3
+		};
+
+		typedef std::function<void()> Task;
+
+		static void run(const Task& task, Priority priority = BACKGROUND);
+
+		// Runs the task on a worker, then the continuation on the UI thread
+		static void run(const Task& task, const Task& continuation, Priority priority = INTERACTIVE);
+
+		// Runs one pending task on the calling thread. Returns false if there was nothing to run
+		static bool runPending();
+
+		static bool isWorkerThread();
+		static bool isStopped();
+
+		// Returns 1 once stopped : tasks then run inline on the calling thread
+		static int  getWorkerCount();
+
+		// Set by the Window : continuations are posted through it
+		static void setUiDispatcher(const std::function<void(const Task&)>& dispatcher);
+
+		// Runs the remaining tasks, and joins the workers. Tasks queued afterwards run inline
+		static void stop();
+
+	private:
+		static void start();
+		static bool pop(int worker, Task& task);
+		static void workerProc(int worker);
+	};
+
+	// A set of tasks that can be waited for, and optionally limited to a number of tasks running at once.
+	// Tasks are queued in the group, and run by as many scheduler tasks as the limit allows.
+	// A waiting thread runs the group's queued tasks itself, so groups can be waited for from a worker.
+	class TaskGroup
+	{
+	public:
+		TaskGroup(int maxConcurrency = 0, TaskScheduler::Priority priority = TaskScheduler::BACKGROUND);
+		~TaskGroup();
+
+		void run(const TaskScheduler::Task& task);
+
+		void wait();
+		void wait(const TaskScheduler::Task& onIdle, int delay = 50);
+
+		// Drops the tasks that are not started yet
+		void cancel();
+
+		bool isIdle();
+
+	private:
+		bool runNext(std::unique_lock<std::mutex>& lock);
+		void drain();
+
+		std::deque<TaskScheduler::Task> mQueue;
+		std::mutex                      mLock;
+		std::condition_variable         mEvent;
+
+		TaskScheduler::Priority         mPriority;
+		int                             mMaxConcurrency;
+
+		int                             mScheduled;   // Drain tasks queued in the scheduler
+		int                             mActive;      // Threads running tasks of this group
+		int                             mOutstanding; // Tasks queued or running
+	};
+}
+
+#endif // ES_CORE_UTILS_TASKSCHEDULER_H
@@ -1,128 +1,69 @@
 #include "ThreadPool.h"
 
-#if WIN32
-#include <Windows.h>
-#endif
-
 #include <stdlib.h>
 
 namespace Utils
 {
-	ThreadPool::ThreadPool(int threadByCore) : mRunning(false), mWaiting(false), mNumWork(0)
+	ThreadPool::ThreadPool(int threadByCore) : mRunning(false), mGroup(threadByCore < 0 ? abs(threadByCore) : 0, TaskScheduler::INTERACTIVE)
 	{
-		mThreadByCore = threadByCore;
 	}
 
-	void ThreadPool::start()
+	ThreadPool::~ThreadPool()
 	{
-		mRunning = true;
+		stop();
+	}
 
-		size_t num_threads = mThreadByCore < 0 ? abs(mThreadByCore) : std::thread::hardware_concurrency() * mThreadByCore;
+	void ThreadPool::start()
+	{
+		std::vector<work_function> deferred;
 
-		auto doWork = [&](size_t id)
 		{
-#if WIN32
-			auto mask = (static_cast<DWORD_PTR>(1) << id);
-			SetThreadAffinityMask(GetCurrentThread(), mask);
-#endif
-
-			while (mRunning)
-			{
-				_mutex.lock();
-				if (!mWorkQueue.empty())
-				{
-					auto work = mWorkQueue.front();
-					mWorkQueue.pop();
-					_mutex.unlock();
+			std::unique_lock<std::mutex> lock(mLock);
+			if (mRunning)
+				return;
 
-					try
-					{
-						work();
-					}
-					catch (...) {}
-					
-					mNumWork--;
-				}
-				else
-				{
-					_mutex.unlock();
-
-					// Extra code : Exit finished threads
-					if (mWaiting)
-						return;
-
-					std::this_thread::yield();
-					std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				}
-			}
-		};
-
-		mThreads.reserve(num_threads);
-
-		for (size_t i = 0; i < num_threads; i++)
-			mThreads.push_back(std::thread(doWork, i));
-	}
-
-	ThreadPool::~ThreadPool()
-	{
-		mRunning = false;
+			mRunning = true;
+			deferred.swap(mDeferred);
+		}
 
-		for (std::thread& t : mThreads)
-			if (t.joinable())
-				t.join();
+		for (auto& work : deferred)
+			mGroup.run(work);
 	}
 
 	void ThreadPool::queueWorkItem(work_function work)
 	{
-		_mutex.lock();
-		mWorkQueue.push(work);
-		mNumWork++;
-		_mutex.unlock();
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			if (!mRunning)
+			{
+				mDeferred.push_back(work);
+				return;
+			}
+		}
+
+		mGroup.run(work);
 	}
 
 	void ThreadPool::wait()
 	{
-		if (!mRunning)
-			start();
-
-		mWaiting = true;
-		while (mNumWork.load() > 0)
-			std::this_thread::yield();
+		start();
+		mGroup.wait();
 	}
 
 	void ThreadPool::wait(work_function work, int delay)
 	{
-		if (!mRunning)
-			start();
-
-		mWaiting = true;
-
-		while (mNumWork.load() > 0)
-		{
-			work();
-
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-		}
+		start();
+		mGroup.wait(work, delay);
 	}
 
 	void ThreadPool::stop()
 	{
-		_mutex.lock();
-
-		while (!mWorkQueue.empty())
 		{
-			mNumWork--;
-			mWorkQueue.pop();
+			std::unique_lock<std::mutex> lock(mLock);
+			mDeferred.clear();
 		}
-		
-		_mutex.unlock();
-		mWaiting = true;
 
-		while (mNumWork.load() > 0)
-		{
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
-		}
+		mGroup.cancel();
+		mGroup.wait();
 	}
 }
@@ -1,19 +1,20 @@
 #ifndef __THREADPOOL
 #define __THREADPOOL
 
-#include <thread>
 #include <mutex>
-#include <queue>
-#include <atomic>
+#include <vector>
 #include <functional>
+#include "utils/TaskScheduler.h"
 
 namespace Utils
 {
+	// A group of work items run on the process-wide TaskScheduler
 	class ThreadPool
 	{
 	public:
 		typedef std::function<void(void)> work_function;
 
+		// threadByCore < 0 limits the pool to abs(threadByCore) items running at once
 		ThreadPool(int threadByCore = 2);
 		~ThreadPool();
 
@@ -28,14 +29,10 @@ namespace Utils
 
 	private:
 		bool mRunning;
-		bool mWaiting;
-		std::queue<work_function> mWorkQueue;
-		std::atomic<size_t> mNumWork;
-		std::mutex _mutex;
-		std::vector<std::thread> mThreads;
-		int mThreadByCore;
-
+		std::mutex mLock;
+		std::vector<work_function> mDeferred; // Items queued before start
+		TaskGroup mGroup;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
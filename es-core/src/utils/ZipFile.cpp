@@ -25,6 +25,31 @@ namespace Utils
 			return (mz_uint32)mz_crc32((mz_uint32)crc, (const mz_uint8 *)ptr, buf_len);
 		}
 
+		bool ZipFile::compressBuffer(const void* data, size_t length, std::vector<unsigned char>& output, int level)
+		{
+			mz_ulong outputLength = mz_compressBound((mz_ulong)length);
+			output.resize(outputLength);
+
+			if (mz_compress2(output.data(), &outputLength, (const unsigned char*)data, (mz_ulong)length, level) != MZ_OK)
+			{
+				output.clear();
+				return false;
+			}
+
+			output.resize(outputLength);
+			output.shrink_to_fit();
+			return true;
+		}
+
+		bool ZipFile::uncompressBuffer(const void* data, size_t length, void* output, size_t outputLength)
+		{
+			mz_ulong written = (mz_ulong)outputLength;
+			if (mz_uncompress((unsigned char*)output, &written, (const unsigned char*)data, (mz_ulong)length) != MZ_OK)
+				return false;
+
+			return written == (mz_ulong)outputLength;
+		}
+
 		#define mZipArchive   ((mz_zip_archive*) mZipFile)
 
 		static const uint16_t cp437_to_unicode[256] = {
@@ -39,6 +39,10 @@ namespace Utils
 
 			static unsigned int computeCRC(unsigned int crc, const void* ptr, size_t buf_len);
 
+			// zlib streams, for in-memory buffers. uncompress expects the exact uncompressed size
+			static bool compressBuffer(const void* data, size_t length, std::vector<unsigned char>& output, int level = 1);
+			static bool uncompressBuffer(const void* data, size_t length, void* output, size_t outputLength);
+
 		private:
 			std::string getInternalFilename(const std::string& fileName);
 